@@ -0,0 +1,247 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "LevelBitmap.h"
+#include "PriceLevel.h"
+#include "Usings.h"
+
+// One side of the book: price -> PriceLevel (FIFO of resting orders and its totals)
+// Compare gives the priority order exactly like the old map comparators did
+// (greater<Price> for bids - highest first, less<Price> for asks - lowest first).
+//
+// Two storages behind the same map like API:
+//  - Ladder: prices inside the configured band live in a flat array indexed by (price - ladderMin_),
+//    so finding a level is an index and no tree node is allocated when a level appears.
+//    The best ladder level is tracked directly in best_, and when it empties the next one is found
+//    through the occupancy bitmap instead of scanning the array.
+//  - Overflow: anything outside the band falls back to the old std::map.
+template <typename Compare>
+class BookSide
+{
+private:
+    // true for bids, the better price is the higher one
+    static constexpr bool Descending = Compare{}(Price{1}, Price{0});
+    static constexpr size_t NoLevel = static_cast<size_t>(-1);
+
+    Price ladderMin_ = 0;
+    vector<PriceLevel> ladder_;
+    LevelBitmap occupied_;
+    size_t ladderLevelCount_ = 0;
+    size_t best_ = NoLevel;
+
+    using Overflow = map<Price, PriceLevel, Compare>;
+    Overflow overflow_;
+    // Nodes of overflow levels that emptied, reused for the next new ones: a map level appearing then costs
+    // no allocation, and an array backed level (LevelQueue) keeps the arrays it already grew
+    static constexpr size_t MaxSpareNodes = 64;
+    vector<typename Overflow::node_type> spareNodes_;
+
+    PriceLevel &NewOverflowLevel(typename Overflow::const_iterator hint, Price price)
+    {
+        if (spareNodes_.empty())
+            return overflow_.emplace_hint(hint, price, PriceLevel{})->second;
+        auto node = std::move(spareNodes_.back());
+        spareNodes_.pop_back();
+        node.key() = price;
+        return overflow_.insert(hint, std::move(node))->second;
+    }
+
+    size_t ToIndex(Price price) const { return static_cast<size_t>(static_cast<int64_t>(price) - ladderMin_); }
+    Price ToPrice(size_t index) const { return static_cast<Price>(ladderMin_ + static_cast<int64_t>(index)); }
+
+    bool InLadder(Price price) const
+    {
+        const int64_t offset = static_cast<int64_t>(price) - ladderMin_;
+        return offset >= 0 && static_cast<uint64_t>(offset) < ladder_.size();
+    }
+
+    // Is index a better than index b (closer to the top of book)
+    static bool IsBetter(size_t a, size_t b) { return Descending ? a > b : a < b; }
+
+    // Next occupied ladder index strictly worse than `from`, NoLevel if there is none
+    size_t NextWorse(size_t from) const
+    {
+        static_assert(LevelBitmap::npos == NoLevel);
+        if constexpr (Descending)
+            return from == 0 ? NoLevel : occupied_.FindPrev(from - 1);
+        else
+            return occupied_.FindNext(from + 1);
+    }
+
+    // Price at the better edge of the band, overflow prices better than it come before the ladder
+    Price BandBestEdge() const { return Descending ? ToPrice(ladder_.size() - 1) : ladderMin_; }
+
+    bool LadderIsBest() const
+    {
+        if (ladderLevelCount_ == 0)
+            return false;
+        if (overflow_.empty())
+            return true;
+        return Compare{}(ToPrice(best_), overflow_.begin()->first);
+    }
+
+public:
+    BookSide() = default;
+    BookSide(const BookSide &) = delete;
+    BookSide &operator=(const BookSide &) = delete;
+
+    // Prices in [minPrice, minPrice + levels) use the array, everything else the map
+    // Must be called while the side is empty
+    void ConfigureLadder(Price minPrice, size_t levels)
+    {
+        if (!empty())
+            throw logic_error("Ladder can only be configured on an empty book side");
+
+        ladderMin_ = minPrice;
+        ladder_ = vector<PriceLevel>(levels);
+        occupied_.Resize(levels);
+        ladderLevelCount_ = 0;
+        best_ = NoLevel;
+    }
+
+    // Drops every level (the orders themselves belong to whoever linked them)
+    void clear()
+    {
+        for (size_t index = occupied_.First(); index != LevelBitmap::npos; index = occupied_.FindNext(index + 1))
+            ladder_[index] = PriceLevel{};
+        occupied_.Resize(ladder_.size());
+        ladderLevelCount_ = 0;
+        best_ = NoLevel;
+        overflow_.clear();
+    }
+
+    bool empty() const { return ladderLevelCount_ == 0 && overflow_.empty(); }
+    // Number of price levels (not orders)
+    size_t size() const { return ladderLevelCount_ + overflow_.size(); }
+
+    // Returns the level for price, creating it when it doesn't exist yet
+    PriceLevel &operator[](Price price)
+    {
+        if (!InLadder(price))
+        {
+            auto iterator = overflow_.lower_bound(price);
+            if (iterator != overflow_.end() && !Compare{}(price, iterator->first))
+                return iterator->second;
+            return NewOverflowLevel(iterator, price);
+        }
+
+        const size_t index = ToIndex(price);
+        if (!occupied_.Test(index))
+        {
+            occupied_.Set(index);
+            ++ladderLevelCount_;
+            if (best_ == NoLevel || IsBetter(index, best_))
+                best_ = index;
+        }
+        return ladder_[index];
+    }
+
+    // Same as operator[] for a price expected to be worse than every level already there
+    // (bulk loading in priority order): the map insert then lands at its end hint instead of searching
+    PriceLevel &AppendLevel(Price price)
+    {
+        if (!InLadder(price))
+            return NewOverflowLevel(overflow_.end(), price);
+        return (*this)[price];
+    }
+
+    PriceLevel &at(Price price)
+    {
+        if (!InLadder(price))
+            return overflow_.at(price);
+
+        const size_t index = ToIndex(price);
+        if (!occupied_.Test(index))
+            throw out_of_range("No price level at this price");
+        return ladder_[index];
+    }
+
+    const PriceLevel *Find(Price price) const
+    {
+        if (!InLadder(price))
+        {
+            auto iterator = overflow_.find(price);
+            return iterator == overflow_.end() ? nullptr : &iterator->second;
+        }
+
+        const size_t index = ToIndex(price);
+        return occupied_.Test(index) ? &ladder_[index] : nullptr;
+    }
+
+    // Drops an (empty) level
+    void erase(Price price)
+    {
+        if (!InLadder(price))
+        {
+            auto node = overflow_.extract(price);
+            if (node && spareNodes_.size() < MaxSpareNodes)
+                spareNodes_.push_back(std::move(node));
+            return;
+        }
+
+        const size_t index = ToIndex(price);
+        if (!occupied_.Test(index))
+            return;
+
+        occupied_.Clear(index);
+        --ladderLevelCount_;
+        if (index == best_)
+            best_ = ladderLevelCount_ == 0 ? NoLevel : NextWorse(index);
+    }
+
+    // Top of book - only valid when !empty()
+    Price BestPrice() const { return LadderIsBest() ? ToPrice(best_) : overflow_.begin()->first; }
+    PriceLevel &BestLevel() { return LadderIsBest() ? ladder_[best_] : overflow_.begin()->second; }
+    const PriceLevel &BestLevel() const { return LadderIsBest() ? ladder_[best_] : overflow_.begin()->second; }
+
+    // Visits levels best first, fn(Price, const PriceLevel &)
+    // If fn returns bool, returning false stops the walk early
+    template <typename Fn>
+    void ForEachLevel(Fn &&fn) const
+    {
+        auto visit = [&fn](Price price, const PriceLevel &level) -> bool
+        {
+            if constexpr (is_same_v<invoke_result_t<Fn &, Price, const PriceLevel &>, bool>)
+                return fn(price, level);
+            else
+            {
+                fn(price, level);
+                return true;
+            }
+        };
+
+        auto overflowIterator = overflow_.begin();
+
+        if (!ladder_.empty())
+        {
+            // Overflow levels better than the whole band
+            const Price edge = BandBestEdge();
+            for (; overflowIterator != overflow_.end() && Compare{}(overflowIterator->first, edge); ++overflowIterator)
+            {
+                if (!visit(overflowIterator->first, overflowIterator->second))
+                    return;
+            }
+
+            // Ladder levels, hopping between occupied slots only
+            for (size_t index = best_; index != NoLevel; index = NextWorse(index))
+            {
+                if (!visit(ToPrice(index), ladder_[index]))
+                    return;
+            }
+        }
+
+        // Whatever is left is worse than the band
+        for (; overflowIterator != overflow_.end(); ++overflowIterator)
+        {
+            if (!visit(overflowIterator->first, overflowIterator->second))
+                return;
+        }
+    }
+};
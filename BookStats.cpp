@@ -0,0 +1,124 @@
+#include "BookStats.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // One per recording thread, only that thread writes it
+    struct ThreadStats
+    {
+        array<SharedLatencyHistogram, BookOperationCount> latency_;
+        SharedLatencyHistogram levelsCrossed_;
+        SharedLatencyHistogram ordersTouched_;
+        RelaxedCounter allocations_;
+    };
+
+    void AddTo(BookStats &stats, const ThreadStats &thread)
+    {
+        for (size_t operation = 0; operation < BookOperationCount; ++operation)
+            stats.latency_[operation].Merge(thread.latency_[operation]);
+        stats.levelsCrossed_.Merge(thread.levelsCrossed_);
+        stats.ordersTouched_.Merge(thread.ordersTouched_);
+        stats.allocations_ += thread.allocations_;
+    }
+
+    // Live threads' stats plus whatever exited threads left behind
+    // The mutex is only taken when a thread records for the first time, when it exits and by GetBookStats
+    struct Registry
+    {
+        mutex mutex_;
+        vector<const ThreadStats *> threads_;
+        BookStats retired_;
+    };
+
+    Registry &GetRegistry()
+    {
+        // Never destroyed, threads can still exit (and unregister) while statics are torn down
+        static Registry *registry = new Registry;
+        return *registry;
+    }
+
+    class ThreadRegistration
+    {
+    private:
+        ThreadStats stats_;
+
+    public:
+        ThreadRegistration()
+        {
+            Registry &registry = GetRegistry();
+            std::scoped_lock lock{registry.mutex_};
+            registry.threads_.push_back(&stats_);
+        }
+
+        ~ThreadRegistration()
+        {
+            Registry &registry = GetRegistry();
+            std::scoped_lock lock{registry.mutex_};
+            AddTo(registry.retired_, stats_);
+            erase(registry.threads_, &stats_);
+        }
+
+        ThreadStats &Stats() { return stats_; }
+    };
+
+    ThreadStats &LocalStats()
+    {
+        thread_local ThreadRegistration registration;
+        return registration.Stats();
+    }
+
+    // TSC ticks to nanoseconds, measured once against steady_clock
+    double MeasureNanosPerTick()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        using namespace std::chrono;
+        const auto wallStart = steady_clock::now();
+        const uint64_t tickStart = __rdtsc();
+        this_thread::sleep_for(milliseconds(10));
+        const uint64_t ticks = __rdtsc() - tickStart;
+        const auto nanos = duration_cast<nanoseconds>(steady_clock::now() - wallStart).count();
+        return ticks ? static_cast<double>(nanos) / static_cast<double>(ticks) : 1.0;
+#else
+        using Period = std::chrono::steady_clock::period;
+        return static_cast<double>(Period::num) * 1e9 / static_cast<double>(Period::den);
+#endif
+    }
+
+    // Measured while the program starts (only in builds with stats), not on the first timed call
+    const double NanosPerTick = BookStatsEnabled ? MeasureNanosPerTick() : 1.0;
+}
+
+BookStats GetBookStats()
+{
+    Registry &registry = GetRegistry();
+    std::scoped_lock lock{registry.mutex_};
+
+    BookStats stats = registry.retired_;
+    for (const ThreadStats *thread : registry.threads_)
+        AddTo(stats, *thread);
+    return stats;
+}
+
+namespace BookStatsDetail
+{
+    void RecordLatency(BookOperation operation, uint64_t ticks)
+    {
+        LocalStats().latency_[static_cast<size_t>(operation)].Record(static_cast<uint64_t>(static_cast<double>(ticks) * NanosPerTick));
+    }
+
+    void RecordMatchPass(uint64_t levelsCrossed, uint64_t ordersTouched)
+    {
+        ThreadStats &stats = LocalStats();
+        stats.levelsCrossed_.Record(levelsCrossed);
+        stats.ordersTouched_.Record(ordersTouched);
+    }
+
+    void RecordAllocation()
+    {
+        ++LocalStats().allocations_;
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+#include "LatencyHistogram.h"
+
+// Per operation latency histograms and match counters, compiled in only with -DORDERBOOK_LATENCY_STATS=1
+// (CMake option ORDERBOOK_LATENCY_STATS). Without it every Record* below is an empty inline function.
+//
+// Each thread records into its own histograms (no locks, no read-modify-write atomics),
+// GetBookStats() adds up every thread's, threads that already exited included.
+#ifndef ORDERBOOK_LATENCY_STATS
+#define ORDERBOOK_LATENCY_STATS 0
+#endif
+inline constexpr bool BookStatsEnabled = ORDERBOOK_LATENCY_STATS != 0;
+
+// What gets timed: the outermost public call (a modify doesn't count as a cancel and an add too)
+// and every match pass on its own
+enum class BookOperation : uint8_t
+{
+    AddOrder,
+    AddOrders, // one SubmitOrders batch
+    CancelOrder,
+    CancelOrders, // one CancelOrders batch
+    ModifyOrder,
+    MatchOrders,
+};
+inline constexpr size_t BookOperationCount = 6;
+
+struct BookStats
+{
+    // Nanoseconds, indexed by BookOperation
+    array<LatencyHistogram, BookOperationCount> latency_;
+    // Per match pass: levels it traded through (each step to the next best bid/ask pair counts one)
+    // and fills, each fill touching one resting order and the incoming one
+    LatencyHistogram levelsCrossed_;
+    LatencyHistogram ordersTouched_;
+    // Heap allocations made by order pools (slabs)
+    uint64_t allocations_ = 0;
+
+    const LatencyHistogram &Latency(BookOperation operation) const { return latency_[static_cast<size_t>(operation)]; }
+};
+
+// Everything recorded so far by every thread
+BookStats GetBookStats();
+
+namespace BookStatsDetail
+{
+    void RecordLatency(BookOperation operation, uint64_t ticks);
+    void RecordMatchPass(uint64_t levelsCrossed, uint64_t ordersTouched);
+    void RecordAllocation();
+}
+
+// Raw timestamp for RecordBookLatency: the TSC where there is one, steady_clock nanoseconds elsewhere
+inline uint64_t ReadBookTicks()
+{
+    if constexpr (!BookStatsEnabled)
+        return 0;
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+inline void RecordBookLatency(BookOperation operation, uint64_t startTicks)
+{
+    if constexpr (BookStatsEnabled)
+        BookStatsDetail::RecordLatency(operation, ReadBookTicks() - startTicks);
+}
+
+inline void RecordMatchPass(uint64_t levelsCrossed, uint64_t ordersTouched)
+{
+    if constexpr (BookStatsEnabled)
+        BookStatsDetail::RecordMatchPass(levelsCrossed, ordersTouched);
+}
+
+inline void RecordBookAllocation()
+{
+    if constexpr (BookStatsEnabled)
+        BookStatsDetail::RecordAllocation();
+}
@@ -6,5 +6,6 @@
 
 struct Constants
 {
-    // static const Price InvalidPrice = std::numeric_limits<Price>::quiet_NaN();
-};
\ No newline at end of file
+    // Price carried by market orders until they are given a real one
+    static constexpr Price InvalidPrice = std::numeric_limits<Price>::min();
+};
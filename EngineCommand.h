@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+#include "OrderModify.h"
+#include "OrderRequest.h"
+
+enum class CommandType : uint8_t
+{
+    Add,
+    Cancel,
+    Modify,
+};
+
+// One inbound instruction for a book owned by a matching thread
+// Fixed size and trivially copyable so it can sit in a ring cell
+// Add uses all of order_, Cancel only order_.orderId_, Modify everything but order_.orderType_
+struct EngineCommand
+{
+    CommandType type_;
+    OrderRequest order_;
+    // Which book, only looked at by ShardedEngine (Submit fills it in)
+    SymbolId symbolId_ = 0;
+
+    static EngineCommand Add(const OrderRequest &order) { return EngineCommand{CommandType::Add, order}; }
+    static EngineCommand Cancel(OrderId orderId)
+    {
+        return EngineCommand{CommandType::Cancel, OrderRequest{OrderType::GoodTillCancel, orderId, Side::Buy, 0, 0}};
+    }
+    static EngineCommand Modify(const OrderModify &order)
+    {
+        return EngineCommand{CommandType::Modify, OrderRequest{OrderType::GoodTillCancel, order.GetOrderId(), order.GetSide(), order.GetPrice(), order.GetQuantity()}};
+    }
+
+    OrderModify ToOrderModify() const { return OrderModify(order_.orderId_, order_.side_, order_.price_, order_.quantity_); }
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include "LevelUpdate.h"
+#include "OrderEvent.h"
+#include "Trade.h"
+#include "Usings.h"
+
+// Why an order was not accepted into the book
+enum class RejectReason
+{
+    DuplicateOrderId,
+    NoLiquidity,     // Market / FillAndKill with nothing to trade against
+    CannotFullyFill, // FillOrKill
+    NotOrderOwner,   // Gateway: a cancel or modify from a connection that didn't enter the order
+};
+
+// Receives what the book does as it happens: acks, fills and cancels
+// It is a plain set of function pointers (no virtual dispatch, no std::function allocation);
+// any callback left null is simply skipped. Build one from an object with MakeExecutionListener.
+struct ExecutionListener
+{
+    void *context_ = nullptr;
+    void (*onAccepted_)(void *context, OrderId orderId) = nullptr;
+    void (*onRejected_)(void *context, OrderId orderId, RejectReason reason) = nullptr;
+    void (*onTrade_)(void *context, const Trade &trade) = nullptr;
+    // remainingQuantity is what was still open when the order left the book
+    void (*onCancelled_)(void *context, OrderId orderId, Quantity remainingQuantity) = nullptr;
+    // Modify that only shrank the order: it kept its place in the queue, remainingQuantity is what is open now
+    void (*onReduced_)(void *context, OrderId orderId, Quantity remainingQuantity) = nullptr;
+    // Once per command (or batch): every level it changed, one entry per level with its final state
+    void (*onLevelUpdates_)(void *context, const LevelUpdate *updates, size_t count) = nullptr;
+    // L3 feed, every add / reduce / execute / delete of a resting order - only called in ORDERBOOK_L3_FEED builds
+    void (*onOrderEvent_)(void *context, const OrderEvent &event) = nullptr;
+};
+
+// Wires up whichever of OnAccepted/OnRejected/OnTrade/OnCancelled/OnReduced/OnLevelUpdates/OnOrderEvent the sink defines
+// The sink must outlive the book (or be replaced) - only its address is kept
+template <typename Sink>
+ExecutionListener MakeExecutionListener(Sink &sink)
+{
+    ExecutionListener listener;
+    listener.context_ = &sink;
+
+    if constexpr (requires(Sink &s, OrderId orderId) { s.OnAccepted(orderId); })
+        listener.onAccepted_ = [](void *context, OrderId orderId)
+        { static_cast<Sink *>(context)->OnAccepted(orderId); };
+
+    if constexpr (requires(Sink &s, OrderId orderId, RejectReason reason) { s.OnRejected(orderId, reason); })
+        listener.onRejected_ = [](void *context, OrderId orderId, RejectReason reason)
+        { static_cast<Sink *>(context)->OnRejected(orderId, reason); };
+
+    if constexpr (requires(Sink &s, const Trade &trade) { s.OnTrade(trade); })
+        listener.onTrade_ = [](void *context, const Trade &trade)
+        { static_cast<Sink *>(context)->OnTrade(trade); };
+
+    if constexpr (requires(Sink &s, OrderId orderId, Quantity quantity) { s.OnCancelled(orderId, quantity); })
+        listener.onCancelled_ = [](void *context, OrderId orderId, Quantity remainingQuantity)
+        { static_cast<Sink *>(context)->OnCancelled(orderId, remainingQuantity); };
+
+    if constexpr (requires(Sink &s, OrderId orderId, Quantity quantity) { s.OnReduced(orderId, quantity); })
+        listener.onReduced_ = [](void *context, OrderId orderId, Quantity remainingQuantity)
+        { static_cast<Sink *>(context)->OnReduced(orderId, remainingQuantity); };
+
+    if constexpr (requires(Sink &s, span<const LevelUpdate> updates) { s.OnLevelUpdates(updates); })
+        listener.onLevelUpdates_ = [](void *context, const LevelUpdate *updates, size_t count)
+        { static_cast<Sink *>(context)->OnLevelUpdates(span<const LevelUpdate>(updates, count)); };
+
+    if constexpr (requires(Sink &s, const OrderEvent &event) { s.OnOrderEvent(event); })
+        listener.onOrderEvent_ = [](void *context, const OrderEvent &event)
+        { static_cast<Sink *>(context)->OnOrderEvent(event); };
+
+    return listener;
+}
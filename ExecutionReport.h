@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ExecutionListener.h"
+#include "TradeInfo.h"
+
+enum class ReportType : uint8_t
+{
+    Accepted,
+    Rejected,
+    Trade,
+    Cancelled,
+    Reduced,
+};
+
+// Flat copy of one ExecutionListener event, for handing results across threads through a ring
+struct ExecutionReport
+{
+    ReportType type_;
+    RejectReason reason_;  // Rejected
+    OrderId orderId_;      // Accepted, Rejected, Cancelled, Reduced
+    Quantity quantity_;    // Cancelled: what was still open, Reduced: what is open now
+    TradeInfo bidTrade_;   // Trade
+    TradeInfo askTrade_;   // Trade
+    SymbolId symbolId_ = 0; // Book that raised it (ShardedEngine), always 0 from a MatchingEngine
+
+    static ExecutionReport Accepted(OrderId orderId) { return ExecutionReport{ReportType::Accepted, {}, orderId, 0, {}, {}}; }
+    static ExecutionReport Rejected(OrderId orderId, RejectReason reason) { return ExecutionReport{ReportType::Rejected, reason, orderId, 0, {}, {}}; }
+    static ExecutionReport Traded(const Trade &trade) { return ExecutionReport{ReportType::Trade, {}, 0, 0, trade.GetBidTrade(), trade.GetAskTrade()}; }
+    static ExecutionReport Cancelled(OrderId orderId, Quantity remaining) { return ExecutionReport{ReportType::Cancelled, {}, orderId, remaining, {}, {}}; }
+    static ExecutionReport Reduced(OrderId orderId, Quantity remaining) { return ExecutionReport{ReportType::Reduced, {}, orderId, remaining, {}, {}}; }
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "Order.h"
+#include "Usings.h"
+
+// Resting orders that expire, so expiry never has to scan the whole book
+// GoodForDay orders share one bucket (they all go at the close), GoodTillTime orders are bucketed by
+// expiry second in time order. Each order remembers its slot, removing it on fill or cancel is a swap with
+// the bucket's last order - O(1) for GoodForDay, one map lookup for GoodTillTime.
+// Other order types are ignored by Add and Remove.
+class ExpiryIndex
+{
+private:
+    using Bucket = vector<Order *>;
+
+    Bucket goodForDay_;
+    map<ExpiryTime, Bucket> timed_;
+    size_t timedCount_ = 0;
+
+    static void Push(Bucket &bucket, Order *order)
+    {
+        order->expirySlot_ = static_cast<uint32_t>(bucket.size());
+        bucket.push_back(order);
+    }
+
+    static void Erase(Bucket &bucket, Order *order)
+    {
+        Order *last = bucket.back();
+        bucket[order->expirySlot_] = last;
+        last->expirySlot_ = order->expirySlot_;
+        bucket.pop_back();
+    }
+
+public:
+    static bool Expires(OrderType type) { return type == OrderType::GoodForDay || type == OrderType::GoodTillTime; }
+
+    void Add(Order *order)
+    {
+        if (order->GetOrderType() == OrderType::GoodForDay)
+            Push(goodForDay_, order);
+        else if (order->GetOrderType() == OrderType::GoodTillTime)
+        {
+            Push(timed_[order->GetExpiry()], order);
+            ++timedCount_;
+        }
+    }
+
+    void Remove(Order *order)
+    {
+        if (order->GetOrderType() == OrderType::GoodForDay)
+            Erase(goodForDay_, order);
+        else if (order->GetOrderType() == OrderType::GoodTillTime)
+        {
+            auto bucket = timed_.find(order->GetExpiry());
+            Erase(bucket->second, order);
+            if (bucket->second.empty())
+                timed_.erase(bucket);
+            --timedCount_;
+        }
+    }
+
+    // Ids of up to limit GoodTillTime orders expiring at or before now, earliest expiry first
+    // Only collects, the caller cancels them (which removes them from here)
+    void CollectDue(ExpiryTime now, size_t limit, OrderIds &orderIds) const
+    {
+        for (auto bucket = timed_.begin(); bucket != timed_.end() && bucket->first <= now; ++bucket)
+        {
+            for (const Order *order : bucket->second)
+            {
+                if (orderIds.size() == limit)
+                    return;
+                orderIds.push_back(order->GetOrderId());
+            }
+        }
+    }
+
+    // Ids of up to limit GoodForDay orders
+    void CollectGoodForDay(size_t limit, OrderIds &orderIds) const
+    {
+        for (auto order = goodForDay_.rbegin(); order != goodForDay_.rend() && orderIds.size() < limit; ++order)
+            orderIds.push_back((*order)->GetOrderId());
+    }
+
+    bool HasTimed() const { return !timed_.empty(); }
+    // Earliest GoodTillTime expiry, only meaningful when HasTimed()
+    ExpiryTime NextExpiry() const { return timed_.begin()->first; }
+
+    size_t GoodForDayCount() const { return goodForDay_.size(); }
+    size_t TimedCount() const { return timedCount_; }
+
+    void clear()
+    {
+        goodForDay_.clear();
+        timed_.clear();
+        timedCount_ = 0;
+    }
+};
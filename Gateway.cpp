@@ -0,0 +1,559 @@
+#include "Gateway.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "MarketHours.h"
+#include "ThreadAffinity.h"
+
+namespace
+{
+    // Reports a connection can queue before the ring has to grow
+    constexpr size_t InitialSendReports = 1024;
+
+    [[noreturn]] void ThrowErrno(const string &what)
+    {
+        throw system_error(errno, generic_category(), what);
+    }
+
+    OrderBookConfig WithoutPruneThread(OrderBookConfig config)
+    {
+        config.startPruneThread_ = false;
+        return config;
+    }
+
+    void CloseIfOpen(int &fd)
+    {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+}
+
+GatewayRequest GatewayRequest::From(uint64_t clientTag, const EngineCommand &command)
+{
+    GatewayRequest request{};
+    request.clientTag_ = clientTag;
+    request.orderId_ = command.order_.orderId_;
+    request.price_ = command.order_.price_;
+    request.quantity_ = command.order_.quantity_;
+    request.commandType_ = static_cast<uint8_t>(command.type_);
+    request.orderType_ = static_cast<uint8_t>(command.order_.orderType_);
+    request.side_ = static_cast<uint8_t>(command.order_.side_);
+    if (IsStopType(command.order_.orderType_))
+        request.stopPrice_ = command.order_.stopPrice_;
+    else
+        request.expiry_ = static_cast<uint32_t>(command.order_.expiry_.time_since_epoch().count());
+    return request;
+}
+
+bool GatewayRequest::IsValid() const
+{
+    return commandType_ <= static_cast<uint8_t>(CommandType::Modify) &&
+           orderType_ <= static_cast<uint8_t>(OrderType::StopLimit) &&
+           side_ <= static_cast<uint8_t>(Side::Sell) &&
+           (commandType_ == static_cast<uint8_t>(CommandType::Cancel) || quantity_ > 0);
+}
+
+EngineCommand GatewayRequest::ToCommand() const
+{
+    const auto orderType = static_cast<OrderType>(orderType_);
+    OrderRequest order{orderType, orderId_, static_cast<Side>(side_), price_, quantity_};
+    if (IsStopType(orderType))
+        order.stopPrice_ = stopPrice_;
+    else
+        order.expiry_ = ExpiryTime{chrono::seconds{expiry_}};
+    return EngineCommand{static_cast<CommandType>(commandType_), order};
+}
+
+GatewayReport GatewayReport::From(uint64_t clientTag, const ExecutionReport &report)
+{
+    GatewayReport out{};
+    out.clientTag_ = clientTag;
+    out.reportType_ = static_cast<uint8_t>(report.type_);
+    out.reason_ = static_cast<uint8_t>(report.reason_);
+    if (report.type_ == ReportType::Trade)
+    {
+        out.orderId_ = report.bidTrade_.orderId_;
+        out.price_ = report.bidTrade_.price_;
+        out.quantity_ = report.bidTrade_.quantity_;
+        out.askOrderId_ = report.askTrade_.orderId_;
+        out.askPrice_ = report.askTrade_.price_;
+    }
+    else
+    {
+        out.orderId_ = report.orderId_;
+        out.quantity_ = report.quantity_;
+    }
+    return out;
+}
+
+Gateway::Gateway(const GatewayConfig &config)
+    : orderBook_{WithoutPruneThread(config.book_)},
+      receiveBufferBytes_{max(sizeof(GatewayRequest), config.receiveBufferBytes_ / sizeof(GatewayRequest) * sizeof(GatewayRequest))},
+      maxEvents_{max(1, config.maxEvents_)},
+      cpu_{config.cpu_},
+      nextMarketClose_{NextMarketClose(chrono::system_clock::now())}
+{
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config.port_);
+    if (::inet_pton(AF_INET, config.address_.c_str(), &address.sin_addr) != 1)
+        throw invalid_argument("Not an IPv4 address: " + config.address_);
+
+    // The destructor doesn't run for a constructor that throws, whatever is open by then is closed here
+    try
+    {
+        listenFd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd_ < 0)
+            ThrowErrno("Cannot create the gateway socket");
+        const int enable = 1;
+        ::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        if (::bind(listenFd_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+            ThrowErrno("Cannot bind " + config.address_ + ":" + to_string(config.port_));
+        if (::listen(listenFd_, SOMAXCONN) != 0)
+            ThrowErrno("Cannot listen on " + config.address_ + ":" + to_string(config.port_));
+        socklen_t length = sizeof(address);
+        ::getsockname(listenFd_, reinterpret_cast<sockaddr *>(&address), &length);
+        port_ = ntohs(address.sin_port);
+
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd_ < 0 || wakeFd_ < 0)
+            ThrowErrno("Cannot set up the gateway's event loop");
+        for (const int fd : {listenFd_, wakeFd_})
+        {
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLET;
+            event.data.fd = fd;
+            if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0)
+                ThrowErrno("Cannot set up the gateway's event loop");
+        }
+    }
+    catch (...)
+    {
+        CloseIfOpen(wakeFd_);
+        CloseIfOpen(epollFd_);
+        CloseIfOpen(listenFd_);
+        throw;
+    }
+
+    orderBook_.SetExecutionListener(MakeExecutionListener(reportSink_));
+}
+
+Gateway::~Gateway()
+{
+    for (auto &[fd, session] : sessions_)
+        ::close(fd);
+    CloseIfOpen(wakeFd_);
+    CloseIfOpen(epollFd_);
+    CloseIfOpen(listenFd_);
+}
+
+void Gateway::Stop()
+{
+    const uint64_t one = 1;
+    const ssize_t written = ::write(wakeFd_, &one, sizeof(one));
+    (void)written;
+}
+
+void Gateway::Run()
+{
+    if (cpu_ >= 0)
+        PinCurrentThread(cpu_);
+
+    vector<epoll_event> events(static_cast<size_t>(maxEvents_));
+    while (true)
+    {
+        // The timeout only bounds how late an idle book expires its orders
+        const int ready = ::epoll_wait(epollFd_, events.data(), maxEvents_, 1000);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            ThrowErrno("epoll_wait failed");
+        }
+
+        bool stop = false;
+        for (int i = 0; i < ready; ++i)
+        {
+            const int fd = events[i].data.fd;
+            if (fd == listenFd_)
+            {
+                Accept();
+                continue;
+            }
+            if (fd == wakeFd_)
+            {
+                uint64_t count;
+                const ssize_t bytes = ::read(wakeFd_, &count, sizeof(count));
+                (void)bytes;
+                stop = true;
+                continue;
+            }
+
+            // Gone already when an earlier event of this batch closed it
+            const auto found = sessions_.find(fd);
+            if (found == sessions_.end())
+                continue;
+            Session &session = *found->second;
+            if (events[i].events & EPOLLERR)
+            {
+                Close(session);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT)
+                session.writable_ = true;
+            ReadAndApply(session);
+        }
+
+        ExpireIfDue();
+        FlushPending();
+        if (stop)
+            return;
+    }
+}
+
+void Gateway::Accept()
+{
+    // Edge triggered: take every pending connection, the next event only comes with a new one
+    while (true)
+    {
+        const int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            // EAGAIN, or out of descriptors - the client waits in the backlog until a later event
+            return;
+        }
+
+        // Reports are small and latency is the point, don't let Nagle hold them back
+        const int enable = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        auto session = make_unique<Session>();
+        session->fd_ = fd;
+        session->receive_.resize(receiveBufferBytes_ / sizeof(uint64_t));
+        session->send_.resize(InitialSendReports);
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.fd = fd;
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            ::close(fd);
+            continue;
+        }
+        sessions_.emplace(fd, std::move(session));
+        ++stats_.connections_;
+    }
+}
+
+void Gateway::Close(Session &session)
+{
+    // close takes the descriptor out of the epoll set as well
+    const int fd = session.fd_;
+    ::close(fd);
+    // Its orders stay in the book with nobody to report to
+    for (auto &[orderId, owner] : owners_)
+        if (owner.session_ == &session)
+            owner.session_ = nullptr;
+    sessions_.erase(fd);
+}
+
+void Gateway::ReadAndApply(Session &session)
+{
+    // Reports held back by a full socket go first
+    if (session.sendCount_ > 0 && !Flush(session))
+        return;
+
+    while (true)
+    {
+        // A client that doesn't read its reports isn't read from either, EPOLLOUT brings us back here
+        if (session.sendCount_ > 0 && !session.writable_)
+            return;
+
+        // One read takes whatever has arrived, up to a full buffer of requests
+        const ssize_t bytes = ::read(session.fd_, session.ReceiveBuffer() + session.received_,
+                                     receiveBufferBytes_ - session.received_);
+        if (bytes > 0)
+        {
+            ++stats_.reads_;
+            session.received_ += static_cast<size_t>(bytes);
+            if (!ApplyReceived(session) || !Flush(session))
+                return;
+            continue;
+        }
+        if (bytes < 0 && errno == EINTR)
+            continue;
+        // Drained, the next edge says when there is more
+        if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+
+        // The client is gone (or the socket failed). Whatever it didn't wait for is dropped
+        Close(session);
+        return;
+    }
+}
+
+bool Gateway::ApplyReceived(Session &session)
+{
+    const size_t whole = session.received_ / sizeof(GatewayRequest) * sizeof(GatewayRequest);
+    const unsigned char *buffer = session.ReceiveBuffer();
+
+    current_ = &session;
+    for (size_t offset = 0; offset < whole; offset += sizeof(GatewayRequest))
+    {
+        // Read where it landed: the buffer is 8 byte aligned and requests always start at a multiple of 32
+        const auto &request = *reinterpret_cast<const GatewayRequest *>(buffer + offset);
+        if (!request.IsValid())
+        {
+            // Out of step with the client, nothing after this can be trusted
+            ++stats_.protocolErrors_;
+            current_ = nullptr;
+            currentRequest_ = nullptr;
+            Close(session);
+            return false;
+        }
+
+        currentTag_ = request.clientTag_;
+        currentReports_ = 0;
+        currentRequest_ = &request;
+        const auto owner = request.commandType_ == static_cast<uint8_t>(CommandType::Add) ? owners_.end() : owners_.find(request.orderId_);
+        if (owner != owners_.end() && owner->second.session_ != &session)
+            QueueCurrent(ExecutionReport::Rejected(request.orderId_, RejectReason::NotOrderOwner));
+        else
+            orderBook_.SubmitCommand(request.ToCommand());
+        if (currentReports_ == 0)
+        {
+            GatewayReport done{};
+            done.clientTag_ = currentTag_;
+            done.orderId_ = request.orderId_;
+            done.reportType_ = GatewayReport::Done;
+            Push(session, done);
+        }
+        session.send_[(session.sendHead_ + session.sendCount_ - 1) & (session.send_.size() - 1)].flags_ |= GatewayReport::LastFlag;
+        ++stats_.requests_;
+    }
+    current_ = nullptr;
+    currentRequest_ = nullptr;
+
+    // A request cut in two by the stream waits at the front for the rest of it
+    session.received_ -= whole;
+    if (session.received_ > 0)
+        memmove(session.ReceiveBuffer(), buffer + whole, session.received_);
+    return true;
+}
+
+void Gateway::OnAccepted(OrderId orderId)
+{
+    // The order the current request adds (or a modify re-adds) now belongs to the requester
+    // Any other ack is a stop order that has triggered, it already has its owner
+    if (current_ && currentRequest_->orderId_ == orderId && currentRequest_->commandType_ != static_cast<uint8_t>(CommandType::Cancel))
+        owners_[orderId] = OrderOwner{current_, currentTag_, currentRequest_->quantity_};
+    Route(orderId, ExecutionReport::Accepted(orderId));
+}
+
+void Gateway::OnRejected(OrderId orderId, RejectReason reason)
+{
+    // The order with that id is someone else's and stays in the book
+    if (reason == RejectReason::DuplicateOrderId)
+    {
+        QueueCurrent(ExecutionReport::Rejected(orderId, reason));
+        return;
+    }
+    Route(orderId, ExecutionReport::Rejected(orderId, reason));
+    owners_.erase(orderId);
+}
+
+void Gateway::OnTrade(const Trade &trade)
+{
+    const auto report = ExecutionReport::Traded(trade);
+    const TradeInfo &bid = trade.GetBidTrade();
+    const TradeInfo &ask = trade.GetAskTrade();
+
+    // One report per connection, a connection that owns both orders gets it once
+    const Session *bidSession = Route(bid.orderId_, report);
+    const auto askOwner = owners_.find(ask.orderId_);
+    if (askOwner == owners_.end() || askOwner->second.session_ != bidSession)
+        Route(ask.orderId_, report);
+
+    Fill(bid.orderId_, bid.quantity_);
+    Fill(ask.orderId_, ask.quantity_);
+}
+
+void Gateway::OnCancelled(OrderId orderId, Quantity remaining)
+{
+    Route(orderId, ExecutionReport::Cancelled(orderId, remaining));
+    owners_.erase(orderId);
+}
+
+void Gateway::OnReduced(OrderId orderId, Quantity remaining)
+{
+    Route(orderId, ExecutionReport::Reduced(orderId, remaining));
+    const auto owner = owners_.find(orderId);
+    if (owner != owners_.end())
+        owner->second.open_ = remaining;
+}
+
+Gateway::Session *Gateway::Route(OrderId orderId, const ExecutionReport &report)
+{
+    const auto owner = owners_.find(orderId);
+    if (owner != owners_.end())
+    {
+        if (owner->second.session_)
+            Queue(*owner->second.session_, owner->second.clientTag_, report);
+        return owner->second.session_;
+    }
+
+    // Not in the book (a rejected add), only the requester wants to hear about it
+    if (current_ && currentRequest_->orderId_ == orderId)
+    {
+        QueueCurrent(report);
+        return current_;
+    }
+    return nullptr;
+}
+
+// A fully filled order has left the book, and its owner entry goes with it
+void Gateway::Fill(OrderId orderId, Quantity quantity)
+{
+    const auto owner = owners_.find(orderId);
+    if (owner == owners_.end())
+        return;
+    if (owner->second.open_ <= quantity)
+        owners_.erase(owner);
+    else
+        owner->second.open_ -= quantity;
+}
+
+void Gateway::Queue(Session &session, uint64_t clientTag, const ExecutionReport &report)
+{
+    if (&session == current_)
+    {
+        QueueCurrent(report);
+        return;
+    }
+
+    // Not part of any request of this session, it goes out after the batch
+    Push(session, GatewayReport::From(clientTag, report));
+    if (!session.flushPending_)
+    {
+        session.flushPending_ = true;
+        pendingFlush_.push_back(session.fd_);
+    }
+}
+
+void Gateway::QueueCurrent(const ExecutionReport &report)
+{
+    Push(*current_, GatewayReport::From(currentTag_, report));
+    ++currentReports_;
+}
+
+void Gateway::Push(Session &session, const GatewayReport &report)
+{
+    const size_t capacity = session.send_.size();
+    if (session.sendCount_ == capacity)
+    {
+        // Unwrap into a ring twice the size, the partly written front report stays at the front
+        vector<GatewayReport> grown(capacity * 2);
+        for (size_t i = 0; i < session.sendCount_; ++i)
+            grown[i] = session.send_[(session.sendHead_ + i) & (capacity - 1)];
+        session.send_ = std::move(grown);
+        session.sendHead_ = 0;
+    }
+    session.send_[(session.sendHead_ + session.sendCount_) & (session.send_.size() - 1)] = report;
+    ++session.sendCount_;
+}
+
+bool Gateway::Flush(Session &session)
+{
+    while (session.sendCount_ > 0)
+    {
+        // The queued reports are at most two runs of the ring, one gather write takes both
+        const size_t capacity = session.send_.size();
+        const size_t first = min(session.sendCount_, capacity - session.sendHead_);
+        iovec pieces[2];
+        pieces[0].iov_base = reinterpret_cast<unsigned char *>(&session.send_[session.sendHead_]) + session.sendOffset_;
+        pieces[0].iov_len = first * sizeof(GatewayReport) - session.sendOffset_;
+        size_t count = 1;
+        if (first < session.sendCount_)
+        {
+            pieces[1].iov_base = session.send_.data();
+            pieces[1].iov_len = (session.sendCount_ - first) * sizeof(GatewayReport);
+            count = 2;
+        }
+
+        // sendmsg is writev with flags: a client that went away is an error here, not a SIGPIPE
+        msghdr message{};
+        message.msg_iov = pieces;
+        message.msg_iovlen = count;
+        const ssize_t written = ::sendmsg(session.fd_, &message, MSG_NOSIGNAL);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                session.writable_ = false;
+                return true;
+            }
+            Close(session);
+            return false;
+        }
+
+        ++stats_.writes_;
+        const size_t bytes = session.sendOffset_ + static_cast<size_t>(written);
+        const size_t reports = bytes / sizeof(GatewayReport);
+        session.sendOffset_ = bytes % sizeof(GatewayReport);
+        session.sendHead_ = (session.sendHead_ + reports) & (capacity - 1);
+        session.sendCount_ -= reports;
+        stats_.reports_ += reports;
+    }
+    return true;
+}
+
+void Gateway::FlushPending()
+{
+    for (const int fd : pendingFlush_)
+    {
+        // Closed by now, or closed and the descriptor reused - an extra Flush of nothing is harmless
+        const auto found = sessions_.find(fd);
+        if (found == sessions_.end())
+            continue;
+        found->second->flushPending_ = false;
+        Flush(*found->second);
+    }
+    pendingFlush_.clear();
+}
+
+// Same as the MatchingEngine's: one slice of due GoodTillTime orders per batch, GoodForDay at the close
+void Gateway::ExpireIfDue()
+{
+    const auto now = chrono::system_clock::now();
+    // Expiry times are whole seconds, so the book is looked at once per second, not once per batch
+    // (an order already due when it arrives waits for the next second), unless a slice left some due ones behind
+    const auto second = chrono::floor<chrono::seconds>(now);
+    if (second == lastExpiryCheck_ && now < nextMarketClose_)
+        return;
+    if (orderBook_.ExpireOrders(second) < OrderBook::ExpirySliceOrders)
+        lastExpiryCheck_ = second;
+    if (now < nextMarketClose_)
+        return;
+
+    orderBook_.CancelGoodForDayOrders();
+    nextMarketClose_ = NextMarketClose(now);
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GatewayProtocol.h"
+#include "OrderBook.h"
+
+struct GatewayConfig
+{
+    // IPv4 address to listen on, 0 as the port picks a free one (Gateway::Port says which)
+    string address_ = "127.0.0.1";
+    uint16_t port_ = 0;
+    // The gateway's thread is the only one touching the book, it never starts a prune thread
+    OrderBookConfig book_{};
+    // Per connection receive buffer, rounded down to whole requests. One read takes at most this much
+    size_t receiveBufferBytes_ = 64 << 10;
+    // Ready connections handled per epoll_wait
+    int maxEvents_ = 64;
+    // CPU to pin the thread calling Run to, -1 leaves it to the scheduler
+    int cpu_ = -1;
+};
+
+// What the event loop has done so far, read it once Run has returned
+struct GatewayStats
+{
+    uint64_t connections_ = 0;
+    uint64_t requests_ = 0;
+    uint64_t reports_ = 0;
+    // read and writev calls that moved data, requests_ / reads_ is the average batch
+    uint64_t reads_ = 0;
+    uint64_t writes_ = 0;
+    // Connections closed for sending something that isn't a request
+    uint64_t protocolErrors_ = 0;
+};
+
+// Order entry over TCP for one OrderBook (see GatewayProtocol.h for the records)
+// A single thread runs everything: an edge triggered epoll loop accepts connections, reads whatever each one has
+// sent until the socket is drained, and applies the requests straight from the receive buffer - a request is read
+// where it landed, never copied out. The reports they cause are queued per connection and go out with one writev
+// per connection per batch, the queue being a ring the writev takes in (at most) two pieces.
+// A connection whose client doesn't read its reports is not read from either until they have gone out.
+//
+// GoodTillTime and GoodForDay expiry run on the loop's thread too, checked between batches.
+//
+// Every order belongs to the connection that added it. Its fills, cancels (expiry included) and reductions go to
+// that connection whoever caused them, and only it may cancel or modify the order - anyone else gets a Rejected
+// report with NotOrderOwner. Reports about an order that reach its owner outside the owner's own request carry
+// the tag of the request that added it and never the LastFlag. Orders outlive their connection, their reports
+// are dropped and nobody can cancel them anymore.
+class Gateway
+{
+private:
+    // Accepted connection: its socket, what has arrived but isn't a whole request yet, and reports not sent yet
+    struct Session
+    {
+        int fd_ = -1;
+        // 8 byte aligned, requests always start at a multiple of their size so they can be read in place
+        vector<uint64_t> receive_;
+        size_t received_ = 0; // bytes
+        // Ring of reports, capacity a power of two, grows when a batch doesn't fit
+        vector<GatewayReport> send_;
+        size_t sendHead_ = 0;  // next report to go out
+        size_t sendCount_ = 0; // reports waiting
+        size_t sendOffset_ = 0; // bytes of the report at sendHead_ already written
+        bool writable_ = true;
+        // Has reports caused by another connection's request or by expiry, Run flushes it after the batch
+        bool flushPending_ = false;
+
+        unsigned char *ReceiveBuffer() { return reinterpret_cast<unsigned char *>(receive_.data()); }
+    };
+
+    // Who added an order that is still in the book
+    struct OrderOwner
+    {
+        Session *session_; // nullptr once the connection is gone
+        uint64_t clientTag_; // Of the request that added it
+        Quantity open_;      // What is left to fill, the entry goes when it reaches 0
+    };
+
+    // Turns book events into reports for the owners of the orders involved
+    struct ReportSink
+    {
+        Gateway *gateway_;
+        void OnAccepted(OrderId orderId) { gateway_->OnAccepted(orderId); }
+        void OnRejected(OrderId orderId, RejectReason reason) { gateway_->OnRejected(orderId, reason); }
+        void OnTrade(const Trade &trade) { gateway_->OnTrade(trade); }
+        void OnCancelled(OrderId orderId, Quantity remaining) { gateway_->OnCancelled(orderId, remaining); }
+        void OnReduced(OrderId orderId, Quantity remaining) { gateway_->OnReduced(orderId, remaining); }
+    };
+
+    OrderBook orderBook_;
+    ReportSink reportSink_{this};
+    int listenFd_ = -1;
+    int epollFd_ = -1;
+    // Written by Stop, wakes epoll_wait from any thread
+    int wakeFd_ = -1;
+    uint16_t port_ = 0;
+    size_t receiveBufferBytes_;
+    int maxEvents_;
+    int cpu_;
+    unordered_map<int, unique_ptr<Session>> sessions_;
+    unordered_map<OrderId, OrderOwner> owners_;
+    // Sessions with flushPending_ set
+    vector<int> pendingFlush_;
+    GatewayStats stats_;
+
+    // Where the request being applied came from, for ReportSink
+    Session *current_ = nullptr;
+    uint64_t currentTag_ = 0;
+    size_t currentReports_ = 0;
+    const GatewayRequest *currentRequest_ = nullptr;
+
+    chrono::system_clock::time_point nextMarketClose_;
+    ExpiryTime lastExpiryCheck_{};
+
+    void Accept();
+    void Close(Session &session);
+    // Reads until the socket is drained (or the session is waiting to send), applying each batch as it arrives
+    void ReadAndApply(Session &session);
+    // Applies the whole requests at the front of the receive buffer, keeps the partial one at the back
+    // Returns false when the session was closed for a malformed request
+    bool ApplyReceived(Session &session);
+    void OnAccepted(OrderId orderId);
+    void OnRejected(OrderId orderId, RejectReason reason);
+    void OnTrade(const Trade &trade);
+    void OnCancelled(OrderId orderId, Quantity remaining);
+    void OnReduced(OrderId orderId, Quantity remaining);
+    // To the order's owner, or to the requester for an order that never made it into the book
+    // Returns the session it was queued for, nullptr when nobody gets it
+    Session *Route(OrderId orderId, const ExecutionReport &report);
+    void Fill(OrderId orderId, Quantity quantity);
+    void Queue(Session &session, uint64_t clientTag, const ExecutionReport &report);
+    void QueueCurrent(const ExecutionReport &report);
+    void Push(Session &session, const GatewayReport &report);
+    void FlushPending();
+    // writev of the queued reports, false when the session was closed for a failed write
+    bool Flush(Session &session);
+    void ExpireIfDue();
+
+public:
+    // Binds and listens right away, throws system_error when it can't
+    explicit Gateway(const GatewayConfig &config);
+    Gateway(const Gateway &) = delete;
+    Gateway &operator=(const Gateway &) = delete;
+    // Closes every connection
+    ~Gateway();
+
+    uint16_t Port() const { return port_; }
+    // Serves connections on the calling thread until Stop
+    void Run();
+    // Any thread (and async signal safe): Run returns once it has finished the batch it is in
+    void Stop();
+
+    // Only from the thread that called Run, or once it has returned
+    const GatewayStats &GetStats() const { return stats_; }
+    const OrderBook &GetOrderBook() const { return orderBook_; }
+};
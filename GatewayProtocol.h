@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+#include "EngineCommand.h"
+#include "ExecutionReport.h"
+
+// Binary order entry protocol spoken by Gateway over TCP
+// Both directions are a plain stream of fixed 32 byte records in the host's byte order (little endian on x86),
+// no framing beyond that: a record never spans a length prefix or delimiter, the receiver just takes 32 bytes at a time.
+// Explicit widths so the layout doesn't depend on enum sizes, same idea as JournalRecord.
+
+// Client -> gateway: one Add, Cancel or Modify
+struct GatewayRequest
+{
+    // Anything the client likes, echoed in every report the request causes (the load generator sends its clock)
+    uint64_t clientTag_;
+    int32_t orderId_;
+    int32_t price_;
+    int32_t quantity_;
+    uint8_t commandType_; // CommandType
+    uint8_t orderType_;   // OrderType, Add only
+    uint8_t side_;        // Side, Add and Modify
+    uint8_t reserved_;
+    union
+    {
+        // GoodTillTime adds: seconds since the epoch
+        uint32_t expiry_;
+        // Stop and StopLimit adds: the trigger price
+        int32_t stopPrice_;
+    };
+    uint32_t reserved2_;
+
+    static GatewayRequest From(uint64_t clientTag, const EngineCommand &command);
+    // False for a record that isn't a command the book understands (unknown enum values, an Add of nothing)
+    bool IsValid() const;
+    EngineCommand ToCommand() const;
+};
+static_assert(sizeof(GatewayRequest) == 32);
+
+// Gateway -> client: one ExecutionReport, sent to the connection that owns the order it is about
+// (a trade to the owners of both orders), or to the requester when the order never made it into the book
+struct GatewayReport
+{
+    // Set on the last report of a request, every request gets exactly one report with it
+    // Reports caused by someone else never have it
+    static constexpr uint8_t LastFlag = 1;
+    // reportType_ of a request that caused nothing else to report (a cancel of an unknown order, say),
+    // only sent so the request still gets its LastFlag
+    static constexpr uint8_t Done = 0xFF;
+
+    uint64_t clientTag_;  // Of the request that caused it, or that added the order when another connection's request (or expiry) did
+    int32_t orderId_;     // Trade: the bid order
+    int32_t price_;       // Trade: the bid order's price
+    int32_t quantity_;    // Trade: traded, Cancelled: what was still open, Reduced: what is open now
+    int32_t askOrderId_;  // Trade
+    int32_t askPrice_;    // Trade
+    uint8_t reportType_;  // ReportType, or Done
+    uint8_t reason_;      // RejectReason, Rejected only
+    uint8_t flags_;
+    uint8_t reserved_;
+
+    static GatewayReport From(uint64_t clientTag, const ExecutionReport &report);
+    bool IsLast() const { return flags_ & LastFlag; }
+};
+static_assert(sizeof(GatewayReport) == 32);
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "EngineCommand.h"
+
+class OrderBook;
+
+struct JournalConfig
+{
+    string path_;
+    // Records the file is preallocated for, it doubles whenever it fills up
+    size_t initialRecords_ = 1 << 20;
+    // Group commit: msync once this many records are pending (Commit() also flushes whatever is pending)
+    // 0 leaves it to explicit Commit() calls
+    size_t groupCommitRecords_ = 1024;
+    // false skips msync entirely - a record is safe from a process crash as soon as Append returns
+    // (it is in the page cache), only a machine crash can lose what the kernel hasn't written back yet
+    bool sync_ = true;
+};
+
+// One journaled command, fixed 32 bytes with explicit widths so the file doesn't depend on enum layouts
+struct JournalRecord
+{
+    uint64_t sequence_; // 1, 2, 3 ... 0 never appears in a written record
+    int32_t orderId_;
+    int32_t price_;
+    int32_t quantity_;
+    uint8_t commandType_;
+    uint8_t orderType_;
+    uint8_t side_;
+    uint8_t reserved_;
+    union
+    {
+        // GoodTillTime adds: seconds since the epoch (unsigned 32 bits last until 2106)
+        uint32_t expiry_;
+        // Stop and StopLimit adds: the trigger price
+        int32_t stopPrice_;
+    };
+    uint32_t checksum_; // over the rest of the record, catches a record torn by a crash
+
+    static JournalRecord From(uint64_t sequence, const EngineCommand &command);
+    EngineCommand ToCommand() const;
+    uint32_t ComputeChecksum() const;
+};
+static_assert(sizeof(JournalRecord) == 32);
+
+// Append only write-ahead journal of the commands applied to a book
+// The file is preallocated and memory mapped, so appending is a 32 byte copy into the mapping - no syscall.
+// Durability against machine crashes comes from msync, done for a whole group of records at once.
+//
+// Opening an existing journal keeps every valid record (sequence numbers in order, checksums match)
+// and drops a torn tail, new appends continue from there. Replay feeds the kept records to a fresh book.
+// Not thread safe, meant to be owned by the single thread that applies the commands.
+class Journal
+{
+private:
+    int fd_ = -1;
+    unsigned char *mapping_ = nullptr;
+    size_t capacity_ = 0; // in records
+    size_t count_ = 0;    // records in the file, recovered ones included
+    size_t committed_ = 0;
+    size_t recovered_ = 0;
+    size_t groupCommitRecords_;
+    bool sync_;
+
+    JournalRecord *Records() const;
+    void Map(size_t capacity);
+    void Unmap();
+    void Grow();
+    void Recover();
+
+public:
+    explicit Journal(const JournalConfig &config);
+    Journal(const Journal &) = delete;
+    Journal &operator=(const Journal &) = delete;
+    // Commits, then unmaps
+    ~Journal();
+
+    // Returns the record's sequence number
+    uint64_t Append(const EngineCommand &command);
+    // Flushes every pending record to disk
+    void Commit();
+
+    uint64_t LastSequence() const { return count_; }
+    // Records found when the journal was opened
+    size_t RecoveredCount() const { return recovered_; }
+
+    // Applies the recovered records after afterSequence to orderBook in order, returns the last sequence applied
+    // (afterSequence is where a snapshot left off, 0 replays everything)
+    // Runs of adds go through SubmitOrders. Reports go to whatever listener the book has, usually none yet
+    uint64_t Replay(OrderBook &orderBook, uint64_t afterSequence = 0) const;
+};
+
+// Read only walk over the records of a journal file someone else mapped (the replay harness)
+// Stops at the same place recovery would: the first missing or torn record
+class JournalView
+{
+private:
+    const JournalRecord *records_ = nullptr;
+    size_t capacity_ = 0;
+    size_t next_ = 0;
+
+public:
+    JournalView() = default;
+    // IsJournal() is false when data doesn't start with a journal header
+    JournalView(const unsigned char *data, size_t size);
+
+    bool IsJournal() const { return records_ != nullptr; }
+    bool Next(JournalRecord &record);
+};
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Occupancy bitmap over the ladder slots of a BookSide
+// Layer 0 has one bit per price level, every layer above has one bit per 64 bit word of the layer below
+// (set when that word is non zero), up to a single summary word at the top.
+// Finding the next/previous occupied level is then a count-trailing/leading-zeros per layer:
+// at most ceil(log64(levels)) words are looked at no matter how far apart the levels are,
+// which is what keeps thin books cheap when the top level empties.
+class LevelBitmap
+{
+private:
+    static constexpr size_t WordBits = 64;
+    static constexpr size_t WordShift = 6;
+
+    vector<vector<uint64_t>> layers_;
+    size_t size_ = 0;
+
+    static size_t WordsFor(size_t bits) { return (bits + WordBits - 1) >> WordShift; }
+
+    // First set bit >= index in layer, npos if none
+    size_t NextSet(size_t layer, size_t index) const
+    {
+        const auto &words = layers_[layer];
+        size_t word = index >> WordShift;
+        if (word >= words.size())
+            return npos;
+
+        const uint64_t bits = words[word] & (~uint64_t{0} << (index & (WordBits - 1)));
+        if (bits)
+            return (word << WordShift) + countr_zero(bits);
+
+        if (layer + 1 == layers_.size())
+            return npos;
+
+        // Let the layer above tell us which word is the next non empty one
+        const size_t next = NextSet(layer + 1, word + 1);
+        if (next == npos)
+            return npos;
+        return (next << WordShift) + countr_zero(words[next]);
+    }
+
+    // Last set bit <= index in layer, npos if none
+    size_t PrevSet(size_t layer, size_t index) const
+    {
+        const auto &words = layers_[layer];
+        const size_t word = index >> WordShift;
+        const size_t bit = index & (WordBits - 1);
+
+        const uint64_t mask = bit == WordBits - 1 ? ~uint64_t{0} : (uint64_t{1} << (bit + 1)) - 1;
+        const uint64_t bits = words[word] & mask;
+        if (bits)
+            return (word << WordShift) + (WordBits - 1 - countl_zero(bits));
+
+        if (word == 0 || layer + 1 == layers_.size())
+            return npos;
+
+        const size_t prev = PrevSet(layer + 1, word - 1);
+        if (prev == npos)
+            return npos;
+        return (prev << WordShift) + (WordBits - 1 - countl_zero(words[prev]));
+    }
+
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    LevelBitmap() = default;
+    explicit LevelBitmap(size_t size) { Resize(size); }
+
+    // Clears everything
+    void Resize(size_t size)
+    {
+        size_ = size;
+        layers_.clear();
+        if (size == 0)
+            return;
+
+        size_t bits = size;
+        do
+        {
+            layers_.emplace_back(WordsFor(bits), 0);
+            bits = layers_.back().size();
+        } while (bits > 1);
+    }
+
+    size_t size() const { return size_; }
+
+    bool Test(size_t index) const
+    {
+        return (layers_[0][index >> WordShift] >> (index & (WordBits - 1))) & 1;
+    }
+
+    void Set(size_t index)
+    {
+        for (auto &words : layers_)
+        {
+            uint64_t &word = words[index >> WordShift];
+            const bool wasEmpty = word == 0;
+            word |= uint64_t{1} << (index & (WordBits - 1));
+            // Upper layers already know about this word
+            if (!wasEmpty)
+                return;
+            index >>= WordShift;
+        }
+    }
+
+    void Clear(size_t index)
+    {
+        for (auto &words : layers_)
+        {
+            uint64_t &word = words[index >> WordShift];
+            word &= ~(uint64_t{1} << (index & (WordBits - 1)));
+            // Word still has levels, upper layers stay as they are
+            if (word != 0)
+                return;
+            index >>= WordShift;
+        }
+    }
+
+    bool Empty() const { return layers_.empty() || layers_.back()[0] == 0; }
+
+    // Lowest / highest set index >= / <= index, npos if there is none
+    size_t FindNext(size_t index) const { return index >= size_ ? npos : NextSet(0, index); }
+    size_t FindPrev(size_t index) const
+    {
+        if (layers_.empty() || index == npos)
+            return npos;
+        return PrevSet(0, index < size_ ? index : size_ - 1);
+    }
+
+    size_t First() const { return FindNext(0); }
+    size_t Last() const { return size_ == 0 ? npos : FindPrev(size_ - 1); }
+};
@@ -2,10 +2,11 @@
 
 #include "Usings.h"
 
-// Struct to represent an order
+// Struct to represent a price level: total remaining quantity and how many orders make it up
 struct LevelInfo
 {
     Price price_;
     Quantity quantity_;
+    Quantity count_{};
 };
 using LevelInfos = vector<LevelInfo>;
\ No newline at end of file
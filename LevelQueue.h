@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "Order.h"
+#include "Usings.h"
+
+// FIFO of the orders resting at a single price level kept as parallel arrays instead of links
+// (the PriceLevel storage in ORDERBOOK_SOA_LEVELS builds, OrderList otherwise)
+//  - orders_[i] and quantities_[i] are the same order: its Order* and its remaining quantity
+//  - slots before head_ have been consumed by fills, the queue runs from head_ to the end
+//  - a cancel from the middle just nulls its slot (each Order knows its slot), walks skip the hole
+// The dead slots are squeezed out only when the arrays would otherwise grow, so a sweep through a deep level
+// reads addresses and quantities from two contiguous arrays instead of chasing one link per order
+class LevelQueue
+{
+private:
+    vector<Order *> orders_;
+    vector<Quantity> quantities_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+
+    static constexpr size_t PrefetchDistance = 4;
+
+    // Consumed or cancelled slots still taking room
+    size_t Dead() const { return orders_.size() - size_; }
+
+    void SkipHoles()
+    {
+        while (head_ < orders_.size() && !orders_[head_])
+            ++head_;
+    }
+
+    void Reset()
+    {
+        orders_.clear();
+        quantities_.clear();
+        head_ = 0;
+    }
+
+    // Moves the live orders to the front, in queue order
+    void Compact()
+    {
+        size_t to = 0;
+        for (size_t from = head_; from < orders_.size(); ++from)
+        {
+            if (!orders_[from])
+                continue;
+            orders_[to] = orders_[from];
+            quantities_[to] = quantities_[from];
+            orders_[to]->levelSlot_ = static_cast<uint32_t>(to);
+            ++to;
+        }
+        orders_.resize(to);
+        quantities_.resize(to);
+        head_ = 0;
+    }
+
+public:
+    class const_iterator
+    {
+    private:
+        const Order *const *current_ = nullptr;
+        const Order *const *end_ = nullptr;
+
+        void Skip()
+        {
+            while (current_ != end_ && !*current_)
+                ++current_;
+        }
+
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = const Order *;
+        using difference_type = ptrdiff_t;
+        using pointer = const Order *const *;
+        using reference = const Order *;
+
+        const_iterator() = default;
+        const_iterator(const Order *const *current, const Order *const *end) : current_{current}, end_{end} { Skip(); }
+
+        reference operator*() const { return *current_; }
+        const_iterator &operator++()
+        {
+            ++current_;
+            Skip();
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+        bool operator==(const const_iterator &other) const { return current_ == other.current_; }
+        bool operator!=(const const_iterator &other) const { return current_ != other.current_; }
+    };
+
+    LevelQueue() = default;
+    // Orders hold their slot index, a copy would leave them pointing into two queues
+    LevelQueue(const LevelQueue &) = delete;
+    LevelQueue &operator=(const LevelQueue &) = delete;
+    LevelQueue(LevelQueue &&) noexcept = default;
+    LevelQueue &operator=(LevelQueue &&) noexcept = default;
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+    Order *front() const { return orders_[head_]; }
+    Quantity FrontQuantity() const { return quantities_[head_]; }
+
+    const_iterator begin() const { return const_iterator{orders_.data() + head_, orders_.data() + orders_.size()}; }
+    const_iterator end() const { return const_iterator{orders_.data() + orders_.size(), orders_.data() + orders_.size()}; }
+
+    // Time priority: new orders always join at the back
+    void push_back(Order *order)
+    {
+        // Reuse dead room before asking for more, at least half of it is garbage so the copy pays for itself
+        if (orders_.size() == orders_.capacity() && Dead() >= size_ && Dead() > 0)
+            Compact();
+        order->levelSlot_ = static_cast<uint32_t>(orders_.size());
+        orders_.push_back(order);
+        quantities_.push_back(order->GetRemainingQuantity());
+        ++size_;
+    }
+
+    // Slots before head_ are never read again, so the front just moves on
+    // The next orders' addresses are right there in the array, so the one a few places back is fetched
+    // while the ones in between are matched, a linked queue can't know it before reaching it
+    void pop_front()
+    {
+        if (--size_ == 0)
+        {
+            Reset();
+            return;
+        }
+        ++head_;
+        SkipHoles();
+        if (head_ + PrefetchDistance < orders_.size())
+            __builtin_prefetch(orders_[head_ + PrefetchDistance]);
+    }
+
+    // Cancel from anywhere in the queue: the slot becomes a hole, the front moves past holes right away
+    void erase(Order *order)
+    {
+        orders_[order->levelSlot_] = nullptr;
+        if (--size_ == 0)
+        {
+            Reset();
+            return;
+        }
+        SkipHoles();
+        // Holes at the back can simply be dropped
+        while (!orders_.back())
+        {
+            orders_.pop_back();
+            quantities_.pop_back();
+        }
+    }
+
+    // Keeps the quantity array in step with a fill or size-down of an order resting here
+    void Reduce(const Order *order, Quantity quantity) { quantities_[order->levelSlot_] -= quantity; }
+};
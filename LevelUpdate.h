@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Side.h"
+#include "Usings.h"
+
+// New state of one price level after a command (L2 delta)
+// count_ == 0 means the level is gone
+struct LevelUpdate
+{
+    Side side_;
+    Price price_;
+    Quantity quantity_;
+    Quantity count_;
+};
@@ -0,0 +1,177 @@
+#include "LoadGenerator.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "GatewayProtocol.h"
+
+namespace
+{
+    [[noreturn]] void ThrowErrno(const string &what)
+    {
+        throw system_error(errno, generic_category(), what);
+    }
+
+    struct Connection
+    {
+        int fd_ = -1;
+        ~Connection()
+        {
+            if (fd_ >= 0)
+                ::close(fd_);
+        }
+    };
+
+    uint64_t NowNanos()
+    {
+        return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // 10% FillAndKill, 20% cancels of an earlier id (filled or not), the rest GoodTillCancel
+    // Buys sit between mid - 5 and mid + 2, sells between mid - 2 and mid + 5, so about a third of the adds cross
+    class OrderFlow
+    {
+    private:
+        mt19937 random_;
+        OrderId firstOrderId_;
+        Price midPrice_;
+
+    public:
+        explicit OrderFlow(const LoadGeneratorConfig &config)
+            : random_{config.seed_}, firstOrderId_{config.firstOrderId_}, midPrice_{config.midPrice_} {}
+
+        EngineCommand Next(uint64_t index)
+        {
+            const auto roll = random_() % 10;
+            if (roll < 2 && index > 0)
+                return EngineCommand::Cancel(firstOrderId_ + static_cast<OrderId>(random_() % index));
+
+            const Side side = random_() % 2 ? Side::Buy : Side::Sell;
+            const auto offset = static_cast<Price>(random_() % 8);
+            const Price price = side == Side::Buy ? midPrice_ - 5 + offset : midPrice_ - 2 + offset;
+            const OrderType type = roll < 3 ? OrderType::FillAndKill : OrderType::GoodTillCancel;
+            return EngineCommand::Add(OrderRequest{type, firstOrderId_ + static_cast<OrderId>(index), side, price,
+                                                   static_cast<Quantity>(1 + random_() % 10)});
+        }
+    };
+}
+
+LoadGeneratorResult RunLoadGenerator(const LoadGeneratorConfig &config)
+{
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config.port_);
+    if (::inet_pton(AF_INET, config.address_.c_str(), &address.sin_addr) != 1)
+        throw invalid_argument("Not an IPv4 address: " + config.address_);
+
+    Connection connection;
+    connection.fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (connection.fd_ < 0)
+        ThrowErrno("Cannot create a socket");
+    if (::connect(connection.fd_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+        ThrowErrno("Cannot connect to " + config.address_ + ":" + to_string(config.port_));
+    const int enable = 1;
+    ::setsockopt(connection.fd_, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    // Non blocking from here on, a full socket in one direction must never stop us draining the other
+    const int fd = connection.fd_;
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    OrderFlow flow(config);
+    const size_t window = max<size_t>(1, config.window_);
+    vector<GatewayRequest> outgoing;
+    outgoing.reserve(window);
+    size_t outgoingOffset = 0; // bytes
+    // 8 byte aligned like the gateway's, reports are read where they landed
+    vector<uint64_t> incoming(8 << 10);
+    size_t received = 0;
+
+    LoadGeneratorResult result;
+    uint64_t sent = 0;
+    size_t inFlight = 0;
+    const auto start = chrono::steady_clock::now();
+    while (result.requests_ < config.requests_)
+    {
+        // Top the window up once the last top up is all out, requests queued together go out in one send
+        if (outgoing.empty())
+        {
+            const uint64_t now = NowNanos();
+            for (; inFlight < window && sent < config.requests_; ++sent, ++inFlight)
+                outgoing.push_back(GatewayRequest::From(now, flow.Next(sent)));
+        }
+
+        bool progress = false;
+        if (!outgoing.empty())
+        {
+            const size_t total = outgoing.size() * sizeof(GatewayRequest);
+            const ssize_t written = ::send(fd, reinterpret_cast<const unsigned char *>(outgoing.data()) + outgoingOffset,
+                                           total - outgoingOffset, MSG_NOSIGNAL);
+            if (written > 0)
+            {
+                progress = true;
+                outgoingOffset += static_cast<size_t>(written);
+                if (outgoingOffset == total)
+                {
+                    outgoing.clear();
+                    outgoingOffset = 0;
+                }
+            }
+            else if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                ThrowErrno("Cannot write to the gateway");
+        }
+
+        unsigned char *buffer = reinterpret_cast<unsigned char *>(incoming.data());
+        const ssize_t bytes = ::recv(fd, buffer + received, incoming.size() * sizeof(uint64_t) - received, 0);
+        if (bytes > 0)
+        {
+            progress = true;
+            const uint64_t now = NowNanos();
+            received += static_cast<size_t>(bytes);
+            const size_t whole = received / sizeof(GatewayReport) * sizeof(GatewayReport);
+            for (size_t offset = 0; offset < whole; offset += sizeof(GatewayReport))
+            {
+                const auto &report = *reinterpret_cast<const GatewayReport *>(buffer + offset);
+                ++result.reports_;
+                if (report.reportType_ == static_cast<uint8_t>(ReportType::Trade))
+                    ++result.trades_;
+                else if (report.reportType_ == static_cast<uint8_t>(ReportType::Rejected))
+                    ++result.rejects_;
+                if (report.IsLast())
+                {
+                    result.roundTrip_.Record(now - report.clientTag_);
+                    ++result.requests_;
+                    --inFlight;
+                }
+            }
+            received -= whole;
+            if (received > 0)
+                memmove(buffer, buffer + whole, received);
+        }
+        else if (bytes == 0)
+            throw runtime_error("The gateway closed the connection");
+        else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            ThrowErrno("Cannot read from the gateway");
+
+        if (progress)
+            continue;
+
+        // Nothing moved: sleep until the gateway answers (or takes more of what is waiting to go out)
+        pollfd ready{fd, static_cast<short>(POLLIN | (outgoing.empty() ? 0 : POLLOUT)), 0};
+        if (::poll(&ready, 1, static_cast<int>(config.timeout_.count())) == 0)
+            throw runtime_error("The gateway stopped answering");
+    }
+    result.elapsed_ = chrono::steady_clock::now() - start;
+    return result;
+}
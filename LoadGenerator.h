@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "LatencyHistogram.h"
+#include "Usings.h"
+
+struct LoadGeneratorConfig
+{
+    // Gateway to connect to
+    string address_ = "127.0.0.1";
+    uint16_t port_ = 0;
+    // Requests to send, the orders get ids firstOrderId_, firstOrderId_ + 1, ...
+    // (give concurrent generators against one gateway ranges that don't overlap)
+    uint64_t requests_ = 100000;
+    OrderId firstOrderId_ = 0;
+    // Requests in flight at once: 1 measures the bare round trip, more measures a gateway with a queue in front
+    size_t window_ = 1;
+    // Random flow around midPrice_: adds on both sides that cross now and then, FillAndKills, cancels of earlier ones
+    Price midPrice_ = 10000;
+    uint32_t seed_ = 1;
+    // Give up when the gateway stays silent this long with requests outstanding
+    chrono::milliseconds timeout_{5000};
+};
+
+struct LoadGeneratorResult
+{
+    uint64_t requests_ = 0;
+    uint64_t reports_ = 0;
+    uint64_t trades_ = 0;
+    uint64_t rejects_ = 0;
+    chrono::nanoseconds elapsed_{0};
+    // Nanoseconds from a request going into the socket to its last report coming out, on the client's clock:
+    // both kernels' TCP stacks, the gateway's loop and the book
+    LatencyHistogram roundTrip_;
+};
+
+// Drives a Gateway from the calling thread over one connection, see GatewayProtocol.h
+// Throws system_error when it can't connect, runtime_error when the gateway closes the connection or stops answering
+LoadGeneratorResult RunLoadGenerator(const LoadGeneratorConfig &config);
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Usings.h"
+
+// Whole file mapping, unmapped and closed when it goes out of scope
+// Used for files that are written or read in one go (snapshots, replay input)
+class MappedFile
+{
+public:
+    // How a read only mapping is going to be walked
+    enum class Access
+    {
+        // Fault the whole file in with the mmap call, for files that are read entirely and right away
+        Populate,
+        // Only read ahead of the cursor, the file may be much larger than the memory it should take
+        Sequential,
+    };
+
+private:
+    int fd_ = -1;
+    unsigned char *data_ = nullptr;
+    size_t size_ = 0;
+
+    [[noreturn]] static void ThrowErrno(const string &what)
+    {
+        throw system_error(errno, generic_category(), what);
+    }
+
+    MappedFile(int fd, size_t size, int protection, Access access, const string &path) : fd_{fd}, size_{size}
+    {
+        if (size_ == 0)
+            return;
+        int flags = MAP_SHARED;
+#ifdef __linux__
+        if (!(protection & PROT_WRITE) && access == Access::Populate)
+            flags |= MAP_POPULATE;
+#endif
+        void *mapping = ::mmap(nullptr, size_, protection, flags, fd_, 0);
+        if (mapping == MAP_FAILED)
+        {
+            ::close(fd_);
+            ThrowErrno("Cannot map " + path);
+        }
+        data_ = static_cast<unsigned char *>(mapping);
+        if (access == Access::Sequential)
+            ::madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+
+public:
+    // Creates (or truncates) path at size bytes, mapped read/write
+    static MappedFile Create(const string &path, size_t size)
+    {
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            ThrowErrno("Cannot create " + path);
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+        {
+            ::close(fd);
+            ThrowErrno("Cannot size " + path);
+        }
+        return MappedFile(fd, size, PROT_READ | PROT_WRITE, Access::Populate, path);
+    }
+
+    static MappedFile Open(const string &path, Access access = Access::Populate)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            ThrowErrno("Cannot open " + path);
+        struct stat status;
+        if (::fstat(fd, &status) != 0)
+        {
+            ::close(fd);
+            ThrowErrno("Cannot stat " + path);
+        }
+        return MappedFile(fd, static_cast<size_t>(status.st_size), PROT_READ, access, path);
+    }
+
+    MappedFile(MappedFile &&other) noexcept
+        : fd_{exchange(other.fd_, -1)}, data_{exchange(other.data_, nullptr)}, size_{exchange(other.size_, 0)}
+    {
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile &operator=(MappedFile &&) = delete;
+
+    ~MappedFile()
+    {
+        if (data_)
+            ::munmap(data_, size_);
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    unsigned char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+    void Sync()
+    {
+        if (data_ && ::msync(data_, size_, MS_SYNC) != 0)
+            ThrowErrno("Cannot sync mapped file");
+    }
+};
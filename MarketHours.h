@@ -0,0 +1,30 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+
+// Market closes at 4:00 PM local time, that is when GoodForDay orders expire
+inline constexpr std::chrono::hours MarketClose{16};
+
+// Next market close strictly after `now` (today's if it hasn't passed yet, otherwise tomorrow's)
+inline std::chrono::system_clock::time_point NextMarketClose(std::chrono::system_clock::time_point now)
+{
+    using namespace std::chrono;
+
+    const auto now_c = system_clock::to_time_t(now);
+    std::tm now_parts;
+    localtime_r(&now_c, &now_parts);
+
+    // If it is already past the end of the trading day, we wait for the next day
+    if (now_parts.tm_hour >= MarketClose.count())
+    {
+        now_parts.tm_mday += 1; // Move to next day
+    }
+
+    now_parts.tm_hour = MarketClose.count();
+    now_parts.tm_min = 0;
+    now_parts.tm_sec = 0;
+    now_parts.tm_isdst = -1; // Let mktime work out DST for the target day
+
+    return system_clock::from_time_t(mktime(&now_parts));
+}
@@ -0,0 +1,161 @@
+#include "MatchingEngine.h"
+
+#include <filesystem>
+
+#include "MarketHours.h"
+#include "ThreadAffinity.h"
+
+namespace
+{
+    OrderBookConfig WithoutPruneThread(OrderBookConfig config)
+    {
+        config.startPruneThread_ = false;
+        return config;
+    }
+
+    // Back off a little when there is nothing to do, spinning a core flat out only pays when it is dedicated
+    void Idle(unsigned &idleSpins)
+    {
+        if (++idleSpins < 64)
+            return;
+        this_thread::yield();
+    }
+}
+
+MatchingEngine::MatchingEngine() : MatchingEngine(MatchingEngineConfig{}) {}
+
+MatchingEngine::MatchingEngine(const MatchingEngineConfig &config)
+    : orderBook_{WithoutPruneThread(config.book_)},
+      journal_{config.journal_.path_.empty() ? nullptr : make_unique<Journal>(config.journal_)},
+      commands_{config.commandCapacity_},
+      reports_{config.reportCapacity_},
+      cpu_{config.cpu_},
+      nextMarketClose_{NextMarketClose(std::chrono::system_clock::now())}
+{
+    // Recovery happens before the listener is attached, the consumer only hears about new commands
+    uint64_t recoveredSequence = 0;
+    if (!config.snapshotPath_.empty() && filesystem::exists(config.snapshotPath_))
+        recoveredSequence = orderBook_.LoadSnapshot(config.snapshotPath_);
+    if (journal_)
+        journal_->Replay(orderBook_, recoveredSequence);
+    orderBook_.SetExecutionListener(MakeExecutionListener(reportSink_));
+
+    matchingThread_ = thread{[this]
+                             { Run(); }};
+}
+
+MatchingEngine::~MatchingEngine()
+{
+    Stop();
+}
+
+void MatchingEngine::Submit(const EngineCommand &command)
+{
+    while (!commands_.TryPush(command))
+        this_thread::yield();
+}
+
+void MatchingEngine::Stop()
+{
+    stop_.store(true, memory_order_release);
+    if (matchingThread_.joinable())
+        matchingThread_.join();
+}
+
+void MatchingEngine::SaveSnapshot(const string &path) const
+{
+    if (matchingThread_.joinable())
+        throw logic_error("Stop the engine before taking a snapshot");
+    orderBook_.SaveSnapshot(path, journal_ ? journal_->LastSequence() : 0);
+}
+
+void MatchingEngine::Run()
+{
+    if (cpu_ >= 0)
+        PinCurrentThread(cpu_);
+
+    // Reading the clock on every command would cost more than the command itself
+    constexpr unsigned ClockCheckInterval = 4096;
+    unsigned commandsSinceClockCheck = 0;
+
+    EngineCommand command;
+    unsigned idleSpins = 0;
+    while (true)
+    {
+        if (commands_.TryPop(command))
+        {
+            idleSpins = 0;
+            Apply(command);
+            // A book that is never idle still has to expire its GoodForDay orders
+            if (++commandsSinceClockCheck == ClockCheckInterval)
+            {
+                commandsSinceClockCheck = 0;
+                ExpireIfDue();
+            }
+            continue;
+        }
+
+        // Ring is empty: this is the only point where stopping is allowed, so nothing queued is lost
+        if (stop_.load(memory_order_acquire))
+        {
+            if (commands_.TryPop(command))
+            {
+                Apply(command);
+                continue;
+            }
+            return;
+        }
+
+        // Nothing queued: the end of a group, make it durable
+        if (journal_)
+            journal_->Commit();
+        ExpireIfDue();
+        Idle(idleSpins);
+    }
+}
+
+void MatchingEngine::Apply(const EngineCommand &command)
+{
+    // Write ahead: the command is in the journal before the book sees it
+    if (journal_)
+        journal_->Append(command);
+    orderBook_.SubmitCommand(command);
+}
+
+void MatchingEngine::Publish(const ExecutionReport &report)
+{
+    // Never drop a report, wait for the consumer instead
+    while (!reports_.TryPush(report))
+        this_thread::yield();
+}
+
+// GoodTillTime and GoodForDay expiry on the matching thread, checked while idle and every ClockCheckInterval commands
+void MatchingEngine::ExpireIfDue()
+{
+    const auto now = std::chrono::system_clock::now();
+    // One slice per check, anything left over goes at the next one
+    expiringIds_.clear();
+    orderBook_.CollectExpiredOrders(std::chrono::floor<std::chrono::seconds>(now), OrderBook::ExpirySliceOrders, expiringIds_);
+    CancelExpired();
+    if (now < nextMarketClose_)
+        return;
+
+    do
+    {
+        expiringIds_.clear();
+        orderBook_.CollectGoodForDayOrders(OrderBook::ExpirySliceOrders, expiringIds_);
+        CancelExpired();
+    } while (expiringIds_.size() == OrderBook::ExpirySliceOrders);
+    nextMarketClose_ = NextMarketClose(now);
+}
+
+// Expiry depends on the clock, which replay doesn't have, so each expired order is journaled as a plain cancel
+void MatchingEngine::CancelExpired()
+{
+    if (expiringIds_.empty())
+        return;
+    if (journal_)
+        for (const OrderId orderId : expiringIds_)
+            journal_->Append(EngineCommand::Cancel(orderId));
+    orderBook_.CancelOrders(expiringIds_);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "EngineCommand.h"
+#include "ExecutionReport.h"
+#include "Journal.h"
+#include "MpscRing.h"
+#include "OrderBook.h"
+
+struct MatchingEngineConfig
+{
+    // The engine's book never starts a prune thread, the matching thread does end of day expiry itself
+    OrderBookConfig book_{};
+    // Both must be powers of two
+    size_t commandCapacity_ = 1 << 16;
+    size_t reportCapacity_ = 1 << 16;
+    // CPU to pin the matching thread to, -1 leaves it to the scheduler
+    int cpu_ = -1;
+    // Write-ahead journal, off while journal_.path_ is empty
+    // An existing journal at that path is replayed into the book before the matching thread starts
+    JournalConfig journal_{};
+    // Snapshot to start from when the file exists, the journal is then only replayed past the snapshot's sequence
+    string snapshotPath_{};
+};
+
+// Single writer front end for an OrderBook
+// Any number of producer threads push commands into a lock-free ring; one matching thread
+// drains it and is the only thread that ever touches the book, so the book needs no locking at all.
+// Acks, fills and cancels come back as ExecutionReports through a second ring that one consumer polls.
+//
+// The matching thread waits for room in the report ring rather than dropping reports, so keep polling.
+class MatchingEngine
+{
+private:
+    OrderBook orderBook_;
+    unique_ptr<Journal> journal_;
+    MpscRing<EngineCommand> commands_;
+    MpscRing<ExecutionReport> reports_;
+    int cpu_;
+
+    // Turns book events (raised on the matching thread) into reports for the consumer
+    struct ReportSink
+    {
+        MatchingEngine *engine_;
+        void OnAccepted(OrderId orderId) { engine_->Publish(ExecutionReport::Accepted(orderId)); }
+        void OnRejected(OrderId orderId, RejectReason reason) { engine_->Publish(ExecutionReport::Rejected(orderId, reason)); }
+        void OnTrade(const Trade &trade) { engine_->Publish(ExecutionReport::Traded(trade)); }
+        void OnCancelled(OrderId orderId, Quantity remaining) { engine_->Publish(ExecutionReport::Cancelled(orderId, remaining)); }
+        void OnReduced(OrderId orderId, Quantity remaining) { engine_->Publish(ExecutionReport::Reduced(orderId, remaining)); }
+    };
+    ReportSink reportSink_{this};
+
+    // Only the matching thread uses them
+    std::chrono::system_clock::time_point nextMarketClose_;
+    OrderIds expiringIds_;
+
+    atomic<bool> stop_{false};
+    // Declared last, started once everything above is constructed
+    thread matchingThread_;
+
+    void Run();
+    void Apply(const EngineCommand &command);
+    void Publish(const ExecutionReport &report);
+    void ExpireIfDue();
+    void CancelExpired();
+
+public:
+    MatchingEngine();
+    explicit MatchingEngine(const MatchingEngineConfig &config);
+    MatchingEngine(const MatchingEngine &) = delete;
+    MatchingEngine &operator=(const MatchingEngine &) = delete;
+    // Processes whatever is already queued, then stops the matching thread
+    ~MatchingEngine();
+
+    // Any thread. TrySubmit fails when the ring is full, Submit waits for room
+    bool TrySubmit(const EngineCommand &command) { return commands_.TryPush(command); }
+    void Submit(const EngineCommand &command);
+
+    // Single consumer thread: hands every queued report to fn, returns how many there were
+    template <typename Fn>
+    size_t PollReports(Fn &&fn)
+    {
+        size_t count = 0;
+        ExecutionReport report;
+        while (reports_.TryPop(report))
+        {
+            fn(report);
+            ++count;
+        }
+        return count;
+    }
+
+    // Stops the matching thread after it has drained the command ring
+    // Afterwards the book can be inspected from the calling thread
+    void Stop();
+    const OrderBook &GetOrderBook() const { return orderBook_; }
+    // Snapshot of the book, stamped with the last journaled sequence - only once stopped
+    void SaveSnapshot(const string &path) const;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+using namespace std;
+
+// Bounded lock-free ring for many producers and a single consumer
+// Every cell carries a sequence number (Vyukov's bounded queue): producers claim a position with one CAS
+// on enqueuePos_ and publish the value by bumping the cell's sequence, the consumer only ever reads
+// the cell it is waiting on. No locks, no allocation after construction, full ring = TryPush fails.
+template <typename T>
+class MpscRing
+{
+private:
+    // Keep the producer and consumer counters on their own cache lines
+    static constexpr size_t CacheLine = 64;
+
+    struct Cell
+    {
+        atomic<size_t> sequence_;
+        T value_;
+    };
+
+    size_t mask_;
+    unique_ptr<Cell[]> cells_;
+    alignas(CacheLine) atomic<size_t> enqueuePos_{0};
+    alignas(CacheLine) size_t dequeuePos_ = 0;
+
+public:
+    // capacity must be a power of two
+    explicit MpscRing(size_t capacity) : mask_{capacity - 1}, cells_{new Cell[capacity]}
+    {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+            throw invalid_argument("MpscRing capacity must be a power of two");
+
+        for (size_t i = 0; i < capacity; ++i)
+            cells_[i].sequence_.store(i, memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing &) = delete;
+    MpscRing &operator=(const MpscRing &) = delete;
+
+    size_t Capacity() const { return mask_ + 1; }
+
+    // Any thread
+    bool TryPush(const T &value)
+    {
+        size_t position = enqueuePos_.load(memory_order_relaxed);
+        Cell *cell;
+        while (true)
+        {
+            cell = &cells_[position & mask_];
+            const size_t sequence = cell->sequence_.load(memory_order_acquire);
+            const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+            if (difference == 0)
+            {
+                // Cell is free for this lap, try to claim the position
+                if (enqueuePos_.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                    break;
+            }
+            else if (difference < 0)
+            {
+                // Consumer hasn't freed this cell yet, ring is full
+                return false;
+            }
+            else
+            {
+                // Another producer got here first
+                position = enqueuePos_.load(memory_order_relaxed);
+            }
+        }
+
+        cell->value_ = value;
+        cell->sequence_.store(position + 1, memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool TryPop(T &value)
+    {
+        Cell &cell = cells_[dequeuePos_ & mask_];
+        const size_t sequence = cell.sequence_.load(memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePos_ + 1) < 0)
+            return false;
+
+        value = cell.value_;
+        // Hand the cell back to producers for the next lap
+        cell.sequence_.store(dequeuePos_ + mask_ + 1, memory_order_release);
+        ++dequeuePos_;
+        return true;
+    }
+};
@@ -1,8 +1,10 @@
 #pragma once
 
-#include <list>
 #include <exception>
 #include <format>
+#include <memory>
+#include <string>
+#include <stdexcept>
 
 #include "OrderType.h"
 #include "Side.h"
@@ -19,9 +21,30 @@ private:
     Quantity initialQuantity_;
     Quantity remainingQuantity_;
 
+    // Intrusive links for the FIFO of the price level this order rests on
+    // Keeping them inside the order means queuing/dequeuing never allocates a list node
+    Order *prev_ = nullptr;
+    Order *next_ = nullptr;
+    friend class OrderList;
+
+    // GoodTillTime only
+    ExpiryTime expiry_{};
+    // Position inside its ExpiryIndex bucket, lets the index drop it in O(1) on fill or cancel
+    uint32_t expirySlot_ = 0;
+    friend class ExpiryIndex;
+
+    // Index in its level's arrays, used instead of prev_/next_ when levels are LevelQueues (ORDERBOOK_SOA_LEVELS)
+    uint32_t levelSlot_ = 0;
+    friend class LevelQueue;
+
+    // Stop and StopLimit only, kept after it triggers
+    Price stopPrice_ = 0;
+
 public:
-    Order(OrderType orderType, OrderId orderId, Side side, Price price, Quantity quantity)
+    Order(OrderType orderType, OrderId orderId, Side side, Price price, Quantity quantity, ExpiryTime expiry = {}, Price stopPrice = 0)
     {
+        expiry_ = expiry;
+        stopPrice_ = stopPrice;
         orderType_ = orderType;
         orderId_ = orderId;
         side_ = side;
@@ -31,11 +54,11 @@ public:
     }
 
     // Constructor for market orders(we don't care about price here we just need to buy/sell)
+    // We can use same constructor for market orders by passing InvalidPrice as price and type as Market
+    // (it has to be a delegating constructor - calling Order(...) in the body would only build a temporary)
     Order(OrderId orderId, Side side, Quantity quantity)
+        : Order(OrderType::Market, orderId, side, Constants::InvalidPrice, quantity)
     {
-        // We can use same constructor for market orders
-        // by passing InvalidPrice as price and type as Market
-        Order(OrderType::Market, orderId, side, -10, quantity);
     }
 
     // Public methods to access order details
@@ -45,6 +68,8 @@ public:
     Price GetPrice() const { return price_; }
     Quantity GetInitialQuantity() const { return initialQuantity_; }
     Quantity GetRemainingQuantity() const { return remainingQuantity_; }
+    ExpiryTime GetExpiry() const { return expiry_; }
+    Price GetStopPrice() const { return stopPrice_; }
     Quantity GetFilledQuantity() const { return GetInitialQuantity() - GetRemainingQuantity(); }
     bool IsFilled() const { return GetRemainingQuantity() == 0; }
     // Public Methods to fill order
@@ -60,23 +85,30 @@ public:
         remainingQuantity_ -= quantity;
     }
 
-    // For market orders we can convert them to GoodTillCancel orders
-    //  by setting the price to the best available price in the order book
-    //  we simply assign the price and change the order type
-    void ToGoodTillCancel(Price price)
+    // Size-down amend: the order shrinks without trading, what was already filled stays filled
+    void Reduce(Quantity quantity)
     {
-        if (GetOrderType() != OrderType::Market)
+        if (quantity > GetRemainingQuantity())
         {
-            throw std::logic_error(std::format("Order ({}) cannot have its price adjusted, only market orders can.", GetOrderId()));
+            throw logic_error("Order (" + to_string(GetOrderId()) + ") cannot be reduced by more than remaining quantity");
         }
 
-        price_ = price;
-        orderType_ = OrderType::GoodTillCancel;
+        initialQuantity_ -= quantity;
+        remainingQuantity_ -= quantity;
+    }
+
+    // A trade printed through the stop price: a Stop order becomes a market order, a StopLimit a limit order
+    void Trigger()
+    {
+        if (GetOrderType() == OrderType::Stop)
+            orderType_ = OrderType::Market;
+        else if (GetOrderType() == OrderType::StopLimit)
+            orderType_ = OrderType::GoodTillCancel;
+        else
+            throw std::logic_error(std::format("Order ({}) cannot be triggered, only stop orders can.", GetOrderId()));
     }
 };
 
-// Stroing single order in multiple datastructure (stored in Orders dictionary & bid/ask based dictionary)
-using OrderPointer = shared_ptr<Order>;
-// Why list not vector - because it gives and iterator which cannot be invalidated despite list growing too large
-// Also gives a simplicity
-using OrderPointers = list<OrderPointer>;
\ No newline at end of file
+// Caller owned order handed to OrderBook::AddOrder(OrderPointer)
+// Inside the book orders are referenced through plain Order* (see OrderPool and OrderList)
+using OrderPointer = shared_ptr<Order>;
\ No newline at end of file
@@ -1,68 +1,145 @@
 #include "OrderBook.h"
 
-#include <numeric>
-#include <ctime>
+#include <algorithm>
 #include <chrono>
 
-void OrderBook::PruneGoodForDayOrders()
-{
-    using namespace std::chrono;
-    const auto end = hours(16); // Market closes at 4:00 PM
+#include "MarketHours.h"
 
-    while (true)
+// Public entry points open one of these, when the outermost one closes the level updates go out
+// and (in ORDERBOOK_LATENCY_STATS builds) the call's latency is recorded
+class OrderBook::CommandScope
+{
+private:
+    OrderBook &orderBook_;
+    BookOperation operation_;
+    uint64_t startTicks_;
+
+public:
+    CommandScope(OrderBook &orderBook, BookOperation operation)
+        : orderBook_{orderBook}, operation_{operation}, startTicks_{ReadBookTicks()}
     {
-        const auto now = system_clock::now();
-        const auto now_c = system_clock::to_time_t(now);
-        std::tm now_parts;
-        localtime_r(&now_c, &now_parts);
+        ++orderBook_.commandScopeDepth_;
+    }
+    CommandScope(const CommandScope &) = delete;
+    CommandScope &operator=(const CommandScope &) = delete;
+    ~CommandScope()
+    {
+        if (--orderBook_.commandScopeDepth_ != 0)
+            return;
+        orderBook_.FlushLevelUpdates();
+        orderBook_.PublishTopOfBook();
+        RecordBookLatency(operation_, startTicks_);
+    }
+};
 
-        // If the current time is past the end of the trading day, we prune GoodForDay orders
-        // But if it exceeds the end time, we wait for the next day
-        if (now_parts.tm_hour >= end.count())
-        {
-            now_parts.tm_mday += 1; // Move to next day
-        }
+template <Side S>
+auto &OrderBook::LevelsOf()
+{
+    if constexpr (S == Side::Buy)
+        return bids_;
+    else
+        return asks_;
+}
 
-        now_parts.tm_hour = end.count();
-        now_parts.tm_min = 0;
-        now_parts.tm_sec = 0;
+template <Side S>
+const auto &OrderBook::LevelsOf() const
+{
+    if constexpr (S == Side::Buy)
+        return bids_;
+    else
+        return asks_;
+}
+
+// Sleeps until the next GoodTillTime expiry or market close, whichever comes first, then expires what is due
+// a slice at a time so orders keep flowing in between
+void OrderBook::PruneExpiredOrders()
+{
+    using namespace std::chrono;
 
-        auto next = system_clock::from_time_t(mktime(&now_parts));
-        auto till = next - now + milliseconds(100); // Adding 100ms to ensure we don't miss the time window
+    while (true)
+    {
+        const auto close = NextMarketClose(system_clock::now());
 
         {
-            // Lock the orders mutex to safely access the orders map
+            // Lock the orders mutex to safely access the expiry index
             std::unique_lock ordersLock{ordersMutex_};
 
-            // Wait until the shutdown flag is set or the condition variable is notified
-            if (shutDown_.load(std::memory_order_acquire) ||
-                shutDownConditionVariable_.wait_for(ordersLock, till) == std::cv_status::timeout)
+            // Adding 100ms to the close to ensure we don't miss the time window
+            auto wake = close + milliseconds(100);
+            if (expiries_.HasTimed())
+                wake = min(wake, time_point_cast<system_clock::duration>(expiries_.NextExpiry()));
+
+            // Sleep until then, unless shutdown comes first or an order expiring earlier arrives
+            // (the predicate also makes spurious wakeups go back to sleep)
+            shutDownConditionVariable_.wait_until(ordersLock, wake, [this]
+                                                  { return shutDown_.load(std::memory_order_acquire) ||
+                                                           expiryRescheduled_.load(std::memory_order_acquire); });
+            if (shutDown_.load(std::memory_order_acquire))
                 return;
+            expiryRescheduled_.store(false, std::memory_order_relaxed);
         }
 
-        OrderIds orderIds;
-        {
-            std::scoped_lock ordersLock{ordersMutex_};
+        const auto now = system_clock::now();
+        if (now >= close)
+            CancelGoodForDayOrders();
+        while (ExpireOrders(floor<seconds>(now)) == ExpirySliceOrders)
+            ;
+    }
+}
 
-            for (const auto &[_, entry] : orders_)
-            {
-                const auto &[order, x] = entry;
-                if (order->GetOrderType() != OrderType::GoodForDay)
-                    continue;
+// Cancels every resting GoodForDay order
+// Called by the prune thread at market close, or by whoever owns the book when it runs without one
+// Straight from the expiry index, and a slice at a time so the lock is never held for all of them
+void OrderBook::CancelGoodForDayOrders()
+{
+    while (true)
+    {
+        std::scoped_lock ordersLock{ordersMutex_};
+        expiringIds_.clear();
+        expiries_.CollectGoodForDay(ExpirySliceOrders, expiringIds_);
+        // Nothing to cancel is no command: no top of book publish, no latency sample
+        if (expiringIds_.empty())
+            return;
+
+        CommandScope commandScope{*this, BookOperation::CancelOrders};
+        for (const OrderId orderId : expiringIds_)
+            CancelOrderInternal(orderId);
+        if (expiringIds_.size() < ExpirySliceOrders)
+            return;
+    }
+}
 
-                orderIds.push_back(order->GetOrderId());
-            }
-        }
+size_t OrderBook::ExpireOrders(ExpiryTime now, size_t maxOrders)
+{
+    std::scoped_lock ordersLock{ordersMutex_};
+    expiringIds_.clear();
+    expiries_.CollectDue(now, maxOrders, expiringIds_);
+    if (expiringIds_.empty())
+        return 0;
 
-        // Cancel all GoodForDay orders
-        CancelOrders(orderIds);
-    }
+    CommandScope commandScope{*this, BookOperation::CancelOrders};
+    for (const OrderId orderId : expiringIds_)
+        CancelOrderInternal(orderId);
+    return expiringIds_.size();
+}
+
+void OrderBook::CollectGoodForDayOrders(size_t maxOrders, OrderIds &orderIds) const
+{
+    std::scoped_lock ordersLock{ordersMutex_};
+    expiries_.CollectGoodForDay(maxOrders, orderIds);
+}
+
+void OrderBook::CollectExpiredOrders(ExpiryTime now, size_t maxOrders, OrderIds &orderIds) const
+{
+    std::scoped_lock ordersLock{ordersMutex_};
+    expiries_.CollectDue(now, maxOrders, orderIds);
 }
 
-// Private API to cancel a list of orders
-void OrderBook::CancelOrders(OrderIds orderIds)
+// Cancels a list of orders under one lock
+void OrderBook::CancelOrders(span<const OrderId> orderIds)
 {
     std::scoped_lock ordersLock{ordersMutex_};
+    CommandScope commandScope{*this, BookOperation::CancelOrders};
 
     for (const auto &orderId : orderIds)
     {
@@ -77,330 +154,781 @@ void OrderBook::CancelOrders(OrderIds orderIds)
 void OrderBook::CancelOrderInternal(OrderId orderId)
 {
     // Check if the order exists in the orders map
-    if (orders_.find(orderId) == orders_.end())
+    OrderEntry entry;
+    if (!orders_.Extract(orderId, entry))
         return;
 
-    const auto [order, orderIterator] = orders_.at(orderId);
-    orders_.erase(orderId);
-    // Here we will see the power of iterators
-    if (order->GetSide() == Side::Sell)
+    Order *order = entry.order_;
+    // A stop still waiting for its trigger isn't on the book, only the trigger book changes
+    if (IsStopType(order->GetOrderType()))
     {
-        auto price = order->GetPrice();
-        auto &orders = asks_.at(price);
-        // No need to traverse whole list, we can use the iterator to remove the order directly
-        orders.erase(orderIterator);
-
-        if (orders.empty())
-        {
-            asks_.erase(price);
-        }
+        RemoveStopOrder(order);
+        EmitCancelled(orderId, order->GetRemainingQuantity());
+        ReleaseOrder(entry);
+        return;
     }
+
+    // Here we will see the power of intrusive links
+    if (order->GetSide() == Side::Buy)
+        UnlinkOrder<Side::Buy>(order);
     else
-    {
-        auto price = order->GetPrice();
-        auto &orders = bids_.at(price);
+        UnlinkOrder<Side::Sell>(order);
 
-        orders.erase(orderIterator);
-        if (orders.empty())
-        {
-            bids_.erase(price);
-        }
-    }
+    expiries_.Remove(order);
+    TouchLevel(order->GetSide(), order->GetPrice());
+    EmitOrderEvent(OrderEventType::Delete, *order, order->GetRemainingQuantity(), OrderEvent::NoQueuePosition);
+    EmitCancelled(orderId, order->GetRemainingQuantity());
+    ReleaseOrder(entry);
+}
 
-    onOrderCancelled(order);
+// No need to traverse the whole level, the order knows its neighbours so it is unlinked directly
+template <Side S>
+void OrderBook::UnlinkOrder(Order *order)
+{
+    auto &levels = LevelsOf<S>();
+    const Price price = order->GetPrice();
+    PriceLevel &orders = levels.at(price);
+    orders.erase(order);
+    if (orders.empty())
+        levels.erase(price);
 }
 
-void OrderBook::onOrderCancelled(OrderPointer order)
+// Removes a fully filled order from the orders map, it has already been unlinked from its level
+void OrderBook::RemoveFilledOrder(OrderId orderId)
 {
+    OrderEntry entry;
+    orders_.Extract(orderId, entry);
+    if (ExpiryIndex::Expires(entry.order_->GetOrderType()))
+    {
+        // The prune thread reads the index under the lock
+        std::scoped_lock ordersLock{ordersMutex_};
+        expiries_.Remove(entry.order_);
+    }
+    ReleaseOrder(entry);
+}
 
-    updateLevelData(order->GetPrice(), order->GetInitialQuantity(), LevelData::Action::Remove);
+void OrderBook::TrackExpiry(Order *order)
+{
+    std::scoped_lock ordersLock{ordersMutex_};
+    TrackExpiryLocked(order);
 }
-void OrderBook::onOrderMatched(Price price, Quantity quantity, bool isFullyFilled)
+
+// Wakes the prune thread when the new order expires before anything it is already waiting for
+// Under the lock like the destructor's shutdown, so the wakeup can't land just before the prune thread waits
+void OrderBook::TrackExpiryLocked(Order *order)
 {
+    const bool earliest = order->GetOrderType() == OrderType::GoodTillTime &&
+                          (!expiries_.HasTimed() || order->GetExpiry() < expiries_.NextExpiry());
+    expiries_.Add(order);
+    if (earliest && ordersPruneThread_.joinable())
+    {
+        expiryRescheduled_.store(true, std::memory_order_release);
+        shutDownConditionVariable_.notify_one();
+    }
+}
 
-    updateLevelData(price, quantity, isFullyFilled ? LevelData::Action::Remove : LevelData::Action::Match);
+// Pooled orders go back to the pool, caller owned orders are released when their owner_ is dropped
+void OrderBook::ReleaseOrder(const OrderEntry &entry)
+{
+    if (!entry.owner_)
+        pool_.Release(entry.order_);
 }
 
-void OrderBook::onOrderAdded(OrderPointer order)
+// Events go straight to the listener as they happen, and into the trades vector
+// only when one of the Trades returning adapters asked for it
+void OrderBook::EmitAccepted(OrderId orderId)
 {
-    // Notify the system that an order has been added
-    // This can be used for logging, analytics, or other purposes
+    if (listener_.onAccepted_)
+        listener_.onAccepted_(listener_.context_, orderId);
+}
 
-    updateLevelData(order->GetPrice(), order->GetInitialQuantity(), LevelData::Action::Add);
+void OrderBook::EmitRejected(OrderId orderId, RejectReason reason)
+{
+    if (listener_.onRejected_)
+        listener_.onRejected_(listener_.context_, orderId, reason);
 }
 
-void OrderBook::updateLevelData(Price price, Quantity quantity, LevelData::Action action)
+void OrderBook::EmitTrade(const Trade &trade)
 {
-    auto &data = data_[price];
+    if (listener_.onTrade_)
+        listener_.onTrade_(listener_.context_, trade);
+    if (collectedTrades_)
+        collectedTrades_->push_back(trade);
+}
 
-    data.count_ += action == LevelData::Action::Remove ? -1 : action == LevelData::Action::Add ? 1
-                                                                                               : 0;
+void OrderBook::EmitCancelled(OrderId orderId, Quantity remainingQuantity)
+{
+    if (listener_.onCancelled_)
+        listener_.onCancelled_(listener_.context_, orderId, remainingQuantity);
+}
 
-    if (action == LevelData::Action::Remove || action == LevelData::Action::Match)
-    {
-        data.quantity_ -= quantity;
-    }
-    else
-    {
-        data.quantity_ += quantity;
-    }
+void OrderBook::EmitReduced(OrderId orderId, Quantity remainingQuantity)
+{
+    if (listener_.onReduced_)
+        listener_.onReduced_(listener_.context_, orderId, remainingQuantity);
+}
 
-    if (data.count_ == 0)
+// Compiles to nothing without ORDERBOOK_L3_FEED, the call sites don't need guards of their own
+void OrderBook::EmitOrderEvent(OrderEventType type, const Order &order, Quantity quantity, uint32_t queuePosition)
+{
+    if constexpr (OrderEventsEnabled)
     {
-        data_.erase(price);
+        if (!listener_.onOrderEvent_)
+            return;
+
+        OrderEvent event{};
+        event.sequence_ = ++orderEventSequence_;
+        event.orderId_ = order.GetOrderId();
+        event.price_ = order.GetPrice();
+        event.quantity_ = quantity;
+        event.remainingQuantity_ = order.GetRemainingQuantity();
+        event.queuePosition_ = queuePosition;
+        event.type_ = type;
+        event.side_ = static_cast<uint8_t>(order.GetSide());
+        listener_.onOrderEvent_(listener_.context_, event);
     }
 }
 
-bool OrderBook::canMatch(Side side, Price price) const
+// Remembers that a level changed, nothing is looked up until the command is done
+void OrderBook::TouchLevel(Side side, Price price, bool existed)
 {
-    if (side == Side::Buy)
-    {
-        if (asks_.empty())
-            return false;
-        // For Buy side, we need to check if the price is greater than or equal to
-        // the lowest ask price (best ask).
-        const auto &[bestAsk, _] = *asks_.begin();
-        return price >= bestAsk;
-    }
-    else
-    {
-        if (bids_.empty())
-            return false;
-        // For Sell side, we need to check if the price is less than or equal to
-        // the highest bid price (best bid).
-        const auto &[bestBid, _] = *bids_.begin();
-        return price <= bestBid;
-    }
+    if (!listener_.onLevelUpdates_)
+        return;
+    // Cheap coalescing for the common case of the same level touched back to back
+    if (!touchedLevels_.empty() && touchedLevels_.back().side_ == side && touchedLevels_.back().price_ == price)
+        return;
+    touchedLevels_.push_back(TouchedLevel{side, price, existed});
 }
 
-bool OrderBook::canFullyFill(Side side, Price price, Quantity quantity) const
+// One update per changed level with its state now, however many times it changed during the command
+// Cost is O(levels touched), independent of how deep the book is
+void OrderBook::FlushLevelUpdates()
 {
-    if (!canMatch(side, price))
-        return false;
+    if (touchedLevels_.empty())
+        return;
 
-    std::optional<Price> threshold;
-    if (side == Side::Buy)
-    {
-        const auto [askPrice, _] = *asks_.begin();
-        threshold = askPrice;
-    }
-    else
+    // Bids best first, then asks best first
+    // Stable so that for each level the first touch (which knows if the level existed before) survives unique
+    stable_sort(touchedLevels_.begin(), touchedLevels_.end(), [](const TouchedLevel &a, const TouchedLevel &b)
+                {
+        if (a.side_ != b.side_)
+            return a.side_ == Side::Buy;
+        return a.side_ == Side::Buy ? a.price_ > b.price_ : a.price_ < b.price_; });
+    touchedLevels_.erase(unique(touchedLevels_.begin(), touchedLevels_.end(), [](const TouchedLevel &a, const TouchedLevel &b)
+                                { return a.side_ == b.side_ && a.price_ == b.price_; }),
+                         touchedLevels_.end());
+
+    levelUpdates_.clear();
+    for (const auto &[side, price, existed] : touchedLevels_)
     {
-        const auto [bidPrice, _] = *bids_.begin();
-        threshold = bidPrice;
+        const PriceLevel *level = side == Side::Buy ? bids_.Find(price) : asks_.Find(price);
+        if (level)
+            levelUpdates_.push_back(LevelUpdate{side, price, level->GetQuantity(), level->GetOrderCount()});
+        else if (existed)
+            levelUpdates_.push_back(LevelUpdate{side, price, 0, 0});
     }
+    touchedLevels_.clear();
+
+    if (listener_.onLevelUpdates_ && !levelUpdates_.empty())
+        listener_.onLevelUpdates_(listener_.context_, levelUpdates_.data(), levelUpdates_.size());
+}
 
-    for (const auto &[levelPrice, levelData] : data_)
+// Runs submit with trades collected into a vector, for the Trades returning API
+template <typename Submit>
+Trades OrderBook::CollectTrades(Submit &&submit)
+{
+    Trades trades;
+    // Reset even if submit throws, collectedTrades_ must never outlive `trades`
+    struct ResetCollector
     {
-        if (threshold.has_value() &&
-                (side == Side::Buy && threshold.value() > levelPrice) ||
-            (side == Side::Sell && threshold.value() < levelPrice))
-            continue;
+        Trades *&collector_;
+        ~ResetCollector() { collector_ = nullptr; }
+    } reset{collectedTrades_};
 
-        if ((side == Side::Buy && levelPrice > price) ||
-            (side == Side::Sell && levelPrice < price))
-            continue;
+    collectedTrades_ = &trades;
+    submit();
+    return trades;
+}
 
-        if (quantity <= levelData.quantity_)
-            return true;
+// Whether an order on side S at price would trade right away: it reaches the opposite side's best level
+template <Side S>
+bool OrderBook::canMatch(Price price) const
+{
+    const auto &resting = LevelsOf<SidePolicy<S>::Opposite>();
+    return !resting.empty() && SidePolicy<S>::Reaches(price, resting.BestPrice());
+}
 
-        quantity -= levelData.quantity_;
-    }
+// FillOrKill admission: walk the opposite side best first and stop as soon as
+// the quantity is covered or the next level is past our limit price.
+// Level totals are already kept by PriceLevel so this is O(levels crossed), not O(levels in book)
+template <Side S>
+bool OrderBook::canFullyFill(Price price, Quantity quantity) const
+{
+    if (!canMatch<S>(price))
+        return false;
+
+    bool canFill = false;
+    LevelsOf<SidePolicy<S>::Opposite>().ForEachLevel([&](Price levelPrice, const PriceLevel &level)
+                                                     {
+        // Levels come in priority order, the first one we can't trade with ends the walk
+        if (!SidePolicy<S>::Reaches(price, levelPrice))
+            return false;
+
+        if (quantity <= level.GetQuantity())
+        {
+            canFill = true;
+            return false;
+        }
+
+        quantity -= level.GetQuantity();
+        return true; });
 
-    return false;
+    return canFill;
 }
 
 // Match orders based on the current order book state
-Trades OrderBook::MatchOrders()
+// Trades are handed out one by one through EmitTrade, nothing is buffered here
+// Aggressor is the side of the order that just came in, trades print at the resting order's price
+// Instantiated per side, so which level is the incoming one and which price prints is fixed at compile time
+template <Side Aggressor>
+void OrderBook::MatchOrders()
 {
-    Trades trades;
-    trades.reserve(orders_.size());
-
-    while (true)
-    {
-
-        // This is the safe check for map of bids and asks orders not the orders themselves
-        if (asks_.empty() || bids_.empty())
-            break;
+    using Policy = SidePolicy<Aggressor>;
+    auto &incomingLevels = LevelsOf<Aggressor>();
+    auto &restingLevels = LevelsOf<Policy::Opposite>();
 
-        // Get the best bid and ask prices
-        auto &[bidPrice, bids] = *bids_.begin();
-        auto &[askPrice, asks] = *asks_.begin();
+    // Only read in ORDERBOOK_LATENCY_STATS builds, otherwise the counting is dead code
+    const uint64_t startTicks = ReadBookTicks();
+    uint64_t levelsCrossed = 0;
+    uint64_t ordersTouched = 0;
 
-        if (bidPrice < askPrice)
+    // This is the safe check for the levels of both sides not the orders themselves
+    while (!incomingLevels.empty() && !restingLevels.empty())
+    {
+        const Price incomingPrice = incomingLevels.BestPrice();
+        const Price restingPrice = restingLevels.BestPrice();
+        if (!Policy::Reaches(incomingPrice, restingPrice))
         {
             // No more matches possible
             break;
         }
 
-        // Match the orders for bids and asks
-        // Note: OrderPointers is a list of shared pointers to Order objects
-        // and prices is the key in the map to the OrderPointers
+        // Match the orders of the two best levels
+        // Note: PriceLevel is an intrusive FIFO of Order* (plus its totals) and price is the key in the book side to it
+        PriceLevel &incoming = incomingLevels.BestLevel();
+        PriceLevel &resting = restingLevels.BestLevel();
+        // Bid and ask views of the same two levels, for the events that are always reported bid first
+        PriceLevel &bids = Aggressor == Side::Buy ? incoming : resting;
+        PriceLevel &asks = Aggressor == Side::Buy ? resting : incoming;
+        TouchLevel(Aggressor, incomingPrice);
+        TouchLevel(Policy::Opposite, restingPrice);
+        ++levelsCrossed;
         while (bids.size() > 0 && asks.size() > 0)
         {
-            // Advantage of using list is that we can use front() & back() methods
-            // Can also use queue
-            auto bid = bids.front();
-            auto ask = asks.front();
+            // Plain pointers - no refcount traffic per fill
+            Order *bid = bids.front();
+            Order *ask = asks.front();
 
             // Check if the bid can match with the ask - suffice the minimum requirements
-            Quantity quantity = min(bid->GetRemainingQuantity(), ask->GetRemainingQuantity());
+            Quantity quantity = min(bids.FrontQuantity(), asks.FrontQuantity());
+            ++ordersTouched;
+
+            // Trade Done so update the quantity (through the levels so their totals follow)
+            bids.Fill(bid, quantity);
+            asks.Fill(ask, quantity);
 
-            // Trade Done so update the quantity
-            bid->Fill(quantity);
-            ask->Fill(quantity);
+            // Both fronts traded, the incoming order already had its Add when it joined its level
+            EmitOrderEvent(OrderEventType::Execute, *bid, quantity, 0);
+            EmitOrderEvent(OrderEventType::Execute, *ask, quantity, 0);
 
-            // Bid order is filled completely
+            // Create a trade info object for the matched order
+            TradeInfo bidTrade{bid->GetOrderId(), bid->GetPrice(), quantity};
+            TradeInfo askTrade{ask->GetOrderId(), ask->GetPrice(), quantity};
+
+            // publish the whole trade information with ask and bid trade information
+            EmitTrade(Trade{bidTrade, askTrade});
+
+            // Every print is checked against the trigger book, a sweep through several levels can set off
+            // stops at each of them
+            lastTradePrice_ = restingPrice;
+            CollectTriggeredStops(lastTradePrice_);
+
+            // Filled orders leave the book last, once released a pooled order can't be touched anymore
             if (bid->IsFilled())
             {
-                // If the bid order is filled, remove it from the bids map
+                // If the bid order is filled, remove it from the bids
                 bids.pop_front();
-                orders_.erase(bid->GetOrderId());
+                RemoveFilledOrder(bid->GetOrderId());
             }
 
             if (ask->IsFilled())
             {
-                // If the ask order is filled, remove it from the asks map
+                // If the ask order is filled, remove it from the asks
                 asks.pop_front();
-                orders_.erase(ask->GetOrderId());
+                RemoveFilledOrder(ask->GetOrderId());
             }
+        }
 
-            // Create a trade info object for the matched order
-            TradeInfo bidTrade{bid->GetOrderId(), bid->GetPrice(), quantity};
-            TradeInfo askTrade{ask->GetOrderId(), ask->GetPrice(), quantity};
+        // Now remove the level if the list is empty
+        if (incoming.empty())
+            incomingLevels.erase(incomingPrice);
+        if (resting.empty())
+            restingLevels.erase(restingPrice);
+    }
 
-            // push the whole trade information with ask and bid trade information
-            trades.push_back(Trade{bidTrade, askTrade});
+    RecordMatchPass(levelsCrossed, ordersTouched);
+    RecordBookLatency(BookOperation::MatchOrders, startTicks);
 
-            // Notify the system that an order has been matched
-            onOrderMatched(bid->GetPrice(), quantity, bid->IsFilled());
-            onOrderMatched(bid->GetPrice(), quantity, ask->IsFilled());
-        }
+    ReleaseTriggeredStops();
+}
 
-        // Now remove from the map if the list is empty
-        if (bids.empty())
-        {
-            bids_.erase(bidPrice);
-        }
-        if (asks.empty())
-        {
-            asks_.erase(askPrice);
-        }
-    }
+// Worst price a market order on side S may trade at: the protection band past the opposite best price,
+// or the end of the price range when there is no band
+template <Side S>
+Price OrderBook::MarketLimit() const
+{
+    const Price best = LevelsOf<SidePolicy<S>::Opposite>().BestPrice();
+    if constexpr (S == Side::Buy)
+        return marketProtectionTicks_ == 0 || best > numeric_limits<Price>::max() - marketProtectionTicks_
+                   ? numeric_limits<Price>::max()
+                   : best + marketProtectionTicks_;
+    else
+        return marketProtectionTicks_ == 0 || best < numeric_limits<Price>::lowest() + marketProtectionTicks_
+                   ? numeric_limits<Price>::lowest()
+                   : best - marketProtectionTicks_;
+}
+
+// Market, FillAndKill and FillOrKill never rest, so they don't go through a level at all: the order walks
+// the opposite side best first down to limit and trades with each resting order in turn. No level, no entry
+// in orders_, no level update or L3 event for it, only its trades and, if anything is left, its cancel
+template <Side S>
+void OrderBook::SweepOrder(OrderEntry &&entry, Price limit)
+{
+    using Policy = SidePolicy<S>;
+    auto &restingLevels = LevelsOf<Policy::Opposite>();
+    Order *order = entry.order_;
+    // A market order has no price of its own, its side of each trade carries the price it traded at
+    const bool market = order->GetOrderType() == OrderType::Market;
+
+    const uint64_t startTicks = ReadBookTicks();
+    uint64_t levelsCrossed = 0;
+    uint64_t ordersTouched = 0;
 
-    // Check for FillAndKill orders
-    if (!bids_.empty())
+    while (!order->IsFilled() && !restingLevels.empty())
     {
-        auto &[_, bids] = *bids_.begin();
-        auto &order = bids.front();
-        if (order->GetOrderType() == OrderType::FillAndKill)
+        const Price restingPrice = restingLevels.BestPrice();
+        if (!Policy::Reaches(limit, restingPrice))
+            break;
+
+        PriceLevel &level = restingLevels.BestLevel();
+        TouchLevel(Policy::Opposite, restingPrice);
+        ++levelsCrossed;
+        while (!level.empty() && !order->IsFilled())
         {
-            CancelOrder(order->GetOrderId());
+            Order *resting = level.front();
+            const Quantity quantity = min(order->GetRemainingQuantity(), level.FrontQuantity());
+            ++ordersTouched;
+
+            order->Fill(quantity);
+            level.Fill(resting, quantity);
+            EmitOrderEvent(OrderEventType::Execute, *resting, quantity, 0);
+
+            const TradeInfo incomingTrade{order->GetOrderId(), market ? restingPrice : order->GetPrice(), quantity};
+            const TradeInfo restingTrade{resting->GetOrderId(), resting->GetPrice(), quantity};
+            if constexpr (S == Side::Buy)
+                EmitTrade(Trade{incomingTrade, restingTrade});
+            else
+                EmitTrade(Trade{restingTrade, incomingTrade});
+
+            lastTradePrice_ = restingPrice;
+            CollectTriggeredStops(lastTradePrice_);
+
+            if (resting->IsFilled())
+            {
+                level.pop_front();
+                RemoveFilledOrder(resting->GetOrderId());
+            }
         }
+
+        if (level.empty())
+            restingLevels.erase(restingPrice);
     }
 
-    if (!asks_.empty())
+    // Out of liquidity or past the limit (a FillOrKill was checked up front and never gets here with a remainder)
+    if (!order->IsFilled())
+        EmitCancelled(order->GetOrderId(), order->GetRemainingQuantity());
+    ReleaseOrder(entry);
+
+    RecordMatchPass(levelsCrossed, ordersTouched);
+    RecordBookLatency(BookOperation::MatchOrders, startTicks);
+
+    ReleaseTriggeredStops();
+}
+
+bool OrderBook::StopTriggered(const Order &order) const
+{
+    if (lastTradePrice_ == Constants::InvalidPrice)
+        return false;
+    return order.GetSide() == Side::Buy ? SidePolicy<Side::Buy>::Reaches(lastTradePrice_, order.GetStopPrice())
+                                        : SidePolicy<Side::Sell>::Reaches(lastTradePrice_, order.GetStopPrice());
+}
+
+// Accepted now, but off the book: no level update, no L3 event and nothing to match until it triggers
+void OrderBook::RestStopOrder(OrderEntry entry)
+{
+    Order *order = entry.order_;
+    EmitAccepted(order->GetOrderId());
+    if (order->GetSide() == Side::Buy)
+        buyStops_[order->GetStopPrice()].push_back(order);
+    else
+        sellStops_[order->GetStopPrice()].push_back(order);
+    orders_.Insert(order->GetOrderId(), std::move(entry));
+}
+
+void OrderBook::RemoveStopOrder(Order *order)
+{
+    auto remove = [order](auto &stops)
+    {
+        PriceLevel &level = stops.at(order->GetStopPrice());
+        level.erase(order);
+        if (level.empty())
+            stops.erase(order->GetStopPrice());
+    };
+    if (order->GetSide() == Side::Buy)
+        remove(buyStops_);
+    else
+        remove(sellStops_);
+}
+
+// Takes every stop a trade at tradePrice went through out of the trigger book, in trigger order
+// Only the front level of each side is compared, so a trade that triggers nothing costs two comparisons
+void OrderBook::CollectTriggeredStops(Price tradePrice)
+{
+    auto release = [this](auto &stops)
     {
-        auto &[_, asks] = *asks_.begin();
-        auto &order = asks.front();
-        if (order->GetOrderType() == OrderType::FillAndKill)
+        const Price stopPrice = stops.BestPrice();
+        PriceLevel &level = stops.BestLevel();
+        while (!level.empty())
         {
-            CancelOrder(order->GetOrderId());
+            triggeredStops_.push_back(level.front());
+            level.pop_front();
         }
-    }
+        stops.erase(stopPrice);
+    };
 
-    return trades;
+    while (!buyStops_.empty() && SidePolicy<Side::Buy>::Reaches(tradePrice, buyStops_.BestPrice()))
+        release(buyStops_);
+    while (!sellStops_.empty() && SidePolicy<Side::Sell>::Reaches(tradePrice, sellStops_.BestPrice()))
+        release(sellStops_);
+}
+
+// Triggered stops go in one at a time as if just submitted (acknowledged again, then matched),
+// after the match pass that triggered them is done. Stops their trades trigger join the same queue
+void OrderBook::ReleaseTriggeredStops()
+{
+    if (releasingStops_ || triggeredStops_.empty())
+        return;
+
+    releasingStops_ = true;
+    for (size_t i = 0; i < triggeredStops_.size(); ++i)
+    {
+        OrderEntry entry;
+        orders_.Extract(triggeredStops_[i]->GetOrderId(), entry);
+        entry.order_->Trigger();
+        AddOrderInternal(std::move(entry));
+    }
+    triggeredStops_.clear();
+    releasingStops_ = false;
 }
 
 /*It starts a new thread when an OrderBook object is created.
-That thread runs the PruneGoodForDayOrders() member function*/
-OrderBook::OrderBook() : ordersPruneThread_{[this]
-                                            { PruneGoodForDayOrders(); }} {}
+That thread runs the PruneExpiredOrders() member function*/
+OrderBook::OrderBook() : OrderBook(OrderBookConfig{}) {}
+
+OrderBook::OrderBook(const OrderBookConfig &config)
+{
+    bids_.ConfigureLadder(config.ladderMinPrice_, config.ladderLevels_);
+    asks_.ConfigureLadder(config.ladderMinPrice_, config.ladderLevels_);
+    orders_.ConfigureDense(config.denseOrderIds_);
+    pool_.Reserve(config.orderPoolReserve_);
+    publishedLevels_ = min(config.publishedLevels_, TopOfBook::MaxLevels);
+    marketProtectionTicks_ = static_cast<Price>(min<size_t>(config.marketProtectionTicks_, numeric_limits<Price>::max()));
+
+    // Started last so the book is fully set up before the thread can look at it
+    if (config.startPruneThread_)
+        ordersPruneThread_ = thread{[this]
+                                    { PruneExpiredOrders(); }};
+}
 
 OrderBook::~OrderBook()
 {
-    shutDown_.store(true, std::memory_order_release);
+    {
+        // Flip the flag under the lock, otherwise the notify can land between the prune thread
+        // checking shutDown_ and starting to wait, and it would sleep until the next market close
+        std::scoped_lock ordersLock{ordersMutex_};
+        shutDown_.store(true, std::memory_order_release);
+    }
     shutDownConditionVariable_.notify_one();
-    ordersPruneThread_.join();
+    if (ordersPruneThread_.joinable())
+        ordersPruneThread_.join();
+}
+
+void OrderBook::SetExecutionListener(ExecutionListener listener)
+{
+    listener_ = listener;
 }
 
 Trades OrderBook::AddOrder(OrderPointer order)
 {
-    if (orders_.find(order->GetOrderId()) != orders_.end())
-        return {};
-    // Convert a market order to a limit order by specifying the best available price
-    // And go on filling it
-    if (order->GetOrderType() == OrderType::Market)
+    return CollectTrades([&]
+                         { SubmitSharedOrder(std::move(order)); });
+}
+
+// The caller's own object rests in the book, OrderEntry keeps it alive until it leaves
+void OrderBook::SubmitSharedOrder(OrderPointer order)
+{
+    CommandScope commandScope{*this, BookOperation::AddOrder};
+    if (orders_.contains(order->GetOrderId()))
     {
-        // Here I have used lowest price available for buy orders and highest price available for sell orders
-        if (order->GetSide() == Side::Buy && !asks_.empty())
-        {
-            // Note- asks_ is sorted in ascending order
-            const auto &[marketAsk, _] = *asks_.begin();
-            order->ToGoodTillCancel(marketAsk);
-        }
-        else if (order->GetSide() == Side::Sell && !bids_.empty())
+        EmitRejected(order->GetOrderId(), RejectReason::DuplicateOrderId);
+        return;
+    }
+
+    Order *raw = order.get();
+    AddOrderInternal(OrderEntry{raw, std::move(order)});
+}
+
+Trades OrderBook::AddOrder(const OrderRequest &request)
+{
+    return CollectTrades([&]
+                         { SubmitOrder(request); });
+}
+
+// Same as AddOrder(OrderPointer) but the order lives in the book's pool - no heap allocation per order
+// and results only go to the execution listener, so there is no Trades vector either
+void OrderBook::SubmitOrder(const OrderRequest &request)
+{
+    CommandScope commandScope{*this, BookOperation::AddOrder};
+    if (orders_.contains(request.orderId_))
+    {
+        EmitRejected(request.orderId_, RejectReason::DuplicateOrderId);
+        return;
+    }
+
+    Order *order = pool_.Acquire(request.orderType_, request.orderId_, request.side_, request.price_, request.quantity_, request.expiry_, request.stopPrice_);
+    AddOrderInternal(OrderEntry{order, nullptr});
+}
+
+Trades OrderBook::AddOrders(span<const OrderRequest> requests)
+{
+    return CollectTrades([&]
+                         { SubmitOrders(requests); });
+}
+
+// Each request still goes through the full admission and matching in order, so price-time priority
+// and the events are exactly those of calling SubmitOrder for each one
+void OrderBook::SubmitOrders(span<const OrderRequest> requests)
+{
+    // The whole burst is one update
+    CommandScope commandScope{*this, BookOperation::AddOrders};
+    // Grow the index once for the whole burst instead of rehashing along the way (a no-op when it already fits)
+    orders_.ReserveFor(requests);
+
+    LevelHint hint;
+    for (const auto &request : requests)
+    {
+        if (orders_.contains(request.orderId_))
         {
-            const auto &[marketBid, _] = *bids_.begin();
-            order->ToGoodTillCancel(marketBid);
+            EmitRejected(request.orderId_, RejectReason::DuplicateOrderId);
+            continue;
         }
-        else
-            return {};
+
+        Order *order = pool_.Acquire(request.orderType_, request.orderId_, request.side_, request.price_, request.quantity_, request.expiry_, request.stopPrice_);
+        AddOrderInternal(OrderEntry{order, nullptr}, &hint);
     }
-    if (order->GetOrderType() == OrderType::FillAndKill && !canMatch(order->GetSide(), order->GetPrice()))
+}
+
+void OrderBook::AddOrderInternal(OrderEntry entry, LevelHint *hint)
+{
+    // The only runtime look at the side, everything past here is compiled for one side
+    if (entry.order_->GetSide() == Side::Buy)
+        AddOrderInternal<Side::Buy>(std::move(entry), hint);
+    else
+        AddOrderInternal<Side::Sell>(std::move(entry), hint);
+}
+
+template <Side S>
+void OrderBook::AddOrderInternal(OrderEntry &&entry, LevelHint *hint)
+{
+    constexpr Side Opposite = SidePolicy<S>::Opposite;
+    Order *order = entry.order_;
+
+    // Stop orders wait in the trigger book, unless the last trade already went through their stop price
+    if (IsStopType(order->GetOrderType()))
     {
-        // If the order is FillAndKill and cannot be matched, return empty trades
-        return {};
+        if (!StopTriggered(*order))
+        {
+            RestStopOrder(std::move(entry));
+            return;
+        }
+        order->Trigger();
     }
 
-    if (order->GetOrderType() == OrderType::FillOrKill && !canFullyFill(order->GetSide(), order->GetPrice(), order->GetInitialQuantity()))
+    // Admission, one switch on the type: only the types named here need anything before the order trades
+    Price limit = order->GetPrice();
+    switch (order->GetOrderType())
     {
-        // If the order is FillOrKill and cannot be fully filled, return empty trades
-        return {};
+    case OrderType::Market:
+        // Trades at whatever the other side offers (lowest asks first for a buy, highest bids for a sell),
+        // down to the protection band if there is one
+        if (LevelsOf<Opposite>().empty())
+        {
+            EmitRejected(order->GetOrderId(), RejectReason::NoLiquidity);
+            ReleaseOrder(entry);
+            return;
+        }
+        limit = MarketLimit<S>();
+        break;
+    case OrderType::FillAndKill:
+        if (!canMatch<S>(order->GetPrice()))
+        {
+            // If the order is FillAndKill and cannot be matched, reject it without trades
+            EmitRejected(order->GetOrderId(), RejectReason::NoLiquidity);
+            ReleaseOrder(entry);
+            return;
+        }
+        break;
+    case OrderType::FillOrKill:
+        if (!canFullyFill<S>(order->GetPrice(), order->GetInitialQuantity()))
+        {
+            // If the order is FillOrKill and cannot be fully filled, reject it without trades
+            EmitRejected(order->GetOrderId(), RejectReason::CannotFullyFill);
+            ReleaseOrder(entry);
+            return;
+        }
+        break;
+    default:
+        break;
     }
 
-    OrderPointers::iterator iterator;
+    // Acknowledge before any fill so listeners always see the ack first
+    EmitAccepted(order->GetOrderId());
 
-    if (order->GetSide() == Side::Buy)
+    if (IsImmediateType(order->GetOrderType()))
     {
-        auto &orders = bids_[order->GetPrice()];
-        orders.push_back(order);
-        iterator = next(orders.begin(), orders.size() - 1);
+        SweepOrder<S>(std::move(entry), limit);
+        // The hint may point at a level the sweep (or a stop it triggered) emptied and erased
+        if (hint)
+            hint->level_ = nullptr;
+        return;
     }
-    else
+
+    const Price price = order->GetPrice();
+    // The book is never left crossed, so an order that doesn't reach the other side can't trade
+    // and the match pass can be skipped
+    const bool crosses = canMatch<S>(price);
+
+    PriceLevel &level = hint && hint->level_ && hint->side_ == S && hint->price_ == price
+                            ? *hint->level_
+                            : LevelsOf<S>()[price];
+    TouchLevel(S, price, !level.empty());
+    level.push_back(order);
+    EmitOrderEvent(OrderEventType::Add, *order, order->GetRemainingQuantity(), static_cast<uint32_t>(level.size() - 1));
+
+    // Add the order to the orders map
+    orders_.Insert(order->GetOrderId(), std::move(entry));
+    if (ExpiryIndex::Expires(order->GetOrderType()))
+        TrackExpiry(order);
+
+    if (!crosses)
     {
-        auto &orders = asks_[order->GetPrice()];
-        orders.push_back(order);
-        iterator = next(orders.begin(), orders.size() - 1);
+        if (hint)
+            *hint = LevelHint{S, price, &level};
+        return;
     }
 
-    // Add the order to the orders map
-    // orders_.insert({order->GetOrderId(), OrderEntry{order, iterator}});
-    orders_[order->GetOrderId()] = OrderEntry{order, iterator};
     // Now match the orders
+    MatchOrders<S>();
+    if (hint)
+        hint->level_ = nullptr;
+}
 
-    // Bookkeeping events
-    onOrderAdded(order);
-
-    return MatchOrders();
+// quantity is the reduction, 0 just acknowledges an amend that changed nothing
+void OrderBook::ReduceOrderInternal(Order *order, Quantity quantity)
+{
+    if (quantity > 0)
+    {
+        if (order->GetSide() == Side::Buy)
+            bids_.at(order->GetPrice()).Reduce(order, quantity);
+        else
+            asks_.at(order->GetPrice()).Reduce(order, quantity);
+        TouchLevel(order->GetSide(), order->GetPrice());
+        EmitOrderEvent(OrderEventType::Reduce, *order, quantity, OrderEvent::NoQueuePosition);
+    }
+    EmitReduced(order->GetOrderId(), order->GetRemainingQuantity());
 }
 
 // Cancel Order function
 void OrderBook::CancelOrder(OrderId orderId)
 {
     std::scoped_lock ordersLock{ordersMutex_};
+    CommandScope commandScope{*this, BookOperation::CancelOrder};
 
     CancelOrderInternal(orderId);
 }
 
 Trades OrderBook::ModifyOrder(OrderModify order)
 {
-    if (orders_.find(order.GetOrderId()) == orders_.end())
-        return {};
+    return CollectTrades([&]
+                         { SubmitModify(order); });
+}
 
-    const auto &[existingOrder, _] = orders_.at(order.GetOrderId());
+// Same price and side, no bigger: shrinks the order where it rests, so it keeps its queue priority
+// (a smaller order at an unchanged price can't cross, there is nothing to match either)
+// Anything else loses priority like a new order would - cancel and re-add (so does any stop still waiting to trigger)
+void OrderBook::SubmitModify(const OrderModify &order)
+{
+    CommandScope commandScope{*this, BookOperation::ModifyOrder};
+    OrderType orderType;
+    ExpiryTime expiry;
+    Price stopPrice;
+    {
+        std::scoped_lock ordersLock{ordersMutex_};
+        const OrderEntry *entry = orders_.Find(order.GetOrderId());
+        if (!entry)
+            return;
+
+        Order *existing = entry->order_;
+        if (!IsStopType(existing->GetOrderType()) && order.GetSide() == existing->GetSide() && order.GetPrice() == existing->GetPrice() &&
+            order.GetQuantity() > 0 && order.GetQuantity() <= existing->GetRemainingQuantity())
+        {
+            ReduceOrderInternal(existing, existing->GetRemainingQuantity() - order.GetQuantity());
+            return;
+        }
+
+        // Read what the order keeps before cancelling, the entry (and a pooled order) is gone afterwards
+        orderType = existing->GetOrderType();
+        expiry = existing->GetExpiry();
+        stopPrice = existing->GetStopPrice();
+    }
     CancelOrder(order.GetOrderId());
-    return AddOrder(order.ToOrderPointer(existingOrder->GetOrderType()));
+    SubmitOrder(order.ToOrderRequest(orderType, expiry, stopPrice));
+}
+
+void OrderBook::SubmitCommand(const EngineCommand &command)
+{
+    switch (command.type_)
+    {
+    case CommandType::Add:
+        SubmitOrder(command.order_);
+        break;
+    case CommandType::Cancel:
+        CancelOrder(command.order_.orderId_);
+        break;
+    case CommandType::Modify:
+        SubmitModify(command.ToOrderModify());
+        break;
+    }
 }
 
 size_t OrderBook::Size() const
@@ -408,32 +936,123 @@ size_t OrderBook::Size() const
     return orders_.size();
 }
 
-// Summarizes the current state of the order book by aggregating the total
-// remaining quantity at each price level for both bids and asks.
+Price OrderBook::GetLastTradePrice() const
+{
+    return lastTradePrice_;
+}
 
+// Summarizes the current state of the order book: total remaining quantity and
+// order count at each price level for both bids and asks.
+// The totals are kept up to date by PriceLevel so this is O(levels), not O(orders)
 OrderBookLevelInfos OrderBook::GetOrderBookLevelInfos() const
 {
     LevelInfos bidInfos, askInfos;
-    bidInfos.reserve(orders_.size());
-    askInfos.reserve(orders_.size());
+    bidInfos.reserve(bids_.size());
+    askInfos.reserve(asks_.size());
 
-    auto CreateLevelInfos = [](Price price, const OrderPointers &orders)
+    auto CreateLevelInfos = [](Price price, const PriceLevel &level)
     {
-        return LevelInfo{price, accumulate(orders.begin(), orders.end(), (Quantity)0,
-                                           [](Quantity runningSum, const OrderPointer &order)
-                                           {
-                                               return runningSum + order->GetRemainingQuantity();
-                                           })};
+        return LevelInfo{price, level.GetQuantity(), level.GetOrderCount()};
     };
 
-    for (const auto &[price, orders] : bids_)
+    bids_.ForEachLevel([&](Price price, const PriceLevel &level)
+                       { bidInfos.push_back(CreateLevelInfos(price, level)); });
+    asks_.ForEachLevel([&](Price price, const PriceLevel &level)
+                       { askInfos.push_back(CreateLevelInfos(price, level)); });
+
+    return OrderBookLevelInfos(std::move(bidInfos), std::move(askInfos));
+}
+
+// Best n levels of one side written into the caller's buffer (room for at least n entries)
+// Only the levels actually returned are visited and nothing is allocated - meant for hot market data polling
+size_t OrderBook::GetTopLevels(Side side, size_t n, LevelInfo *out) const
+{
+    size_t written = 0;
+    auto collect = [&](Price price, const PriceLevel &level)
     {
-        bidInfos.push_back(CreateLevelInfos(price, orders));
-    }
-    for (const auto &[price, orders] : asks_)
+        if (written == n)
+            return false;
+        out[written++] = LevelInfo{price, level.GetQuantity(), level.GetOrderCount()};
+        return true;
+    };
+
+    if (side == Side::Buy)
+        bids_.ForEachLevel(collect);
+    else
+        asks_.ForEachLevel(collect);
+
+    return written;
+}
+
+// Runs on the book's thread only (single writer), O(publishedLevels_) per command
+void OrderBook::PublishTopOfBook()
+{
+    if (publishedLevels_ == 0)
+        return;
+
+    TopOfBook &top = publishing_;
+    ++top.sequence_;
+    top.orderCount_ = orders_.size();
+    top.lastTradePrice_ = lastTradePrice_;
+
+    uint32_t bidCount = 0, askCount = 0;
+    bids_.ForEachLevel([&](Price price, const PriceLevel &level)
+                       {
+                           if (bidCount == publishedLevels_)
+                               return false;
+                           top.rows_[bidCount++].bid_ = LevelInfo{price, level.GetQuantity(), level.GetOrderCount()};
+                           return true; });
+    asks_.ForEachLevel([&](Price price, const PriceLevel &level)
+                       {
+                           if (askCount == publishedLevels_)
+                               return false;
+                           top.rows_[askCount++].ask_ = LevelInfo{price, level.GetQuantity(), level.GetOrderCount()};
+                           return true; });
+    top.bidLevelCount_ = bidCount;
+    top.askLevelCount_ = askCount;
+
+    topOfBook_.Store(top, top.UsedSize());
+}
+
+TopOfBook OrderBook::GetTopOfBook() const
+{
+    return topOfBook_.Load();
+}
+
+uint64_t OrderBook::GetStateChecksum() const
+{
+    std::scoped_lock ordersLock{ordersMutex_};
+
+    uint64_t hash = 0x9E3779B97F4A7C15ULL;
+    auto mix = [&](uint64_t value)
     {
-        askInfos.push_back(CreateLevelInfos(price, orders));
-    }
+        hash = (hash ^ value) * 0xBF58476D1CE4E5B9ULL;
+        hash ^= hash >> 31;
+    };
+    auto mixLevel = [&](Price price, const PriceLevel &level)
+    {
+        mix(static_cast<uint32_t>(price));
+        for (const Order *order : level.GetOrders())
+            mix(static_cast<uint64_t>(static_cast<uint32_t>(order->GetOrderId())) << 32 | static_cast<uint32_t>(order->GetRemainingQuantity()));
+    };
 
-    return OrderBookLevelInfos(bidInfos, askInfos);
-}
\ No newline at end of file
+    // Waiting stops are keyed by stop price, their orders also carry the limit price and type they trigger as
+    auto mixStopLevel = [&](Price stopPrice, const PriceLevel &level)
+    {
+        mixLevel(stopPrice, level);
+        for (const Order *order : level.GetOrders())
+            mix(static_cast<uint64_t>(static_cast<uint32_t>(order->GetPrice())) << 8 | static_cast<uint8_t>(order->GetOrderType()));
+    };
+
+    bids_.ForEachLevel(mixLevel);
+    // Keeps a level moving from one side (or book) to another from hashing the same
+    mix(~uint64_t{0});
+    asks_.ForEachLevel(mixLevel);
+    mix(~uint64_t{0});
+    buyStops_.ForEachLevel(mixStopLevel);
+    mix(~uint64_t{0});
+    sellStops_.ForEachLevel(mixStopLevel);
+    // Decides which stops the next trade triggers
+    mix(static_cast<uint32_t>(lastTradePrice_));
+    return hash;
+}
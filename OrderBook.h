@@ -1,15 +1,31 @@
 // pre-processive directives ensures that header files are compiled only once
 #pragma once
 // Include necessary imports only
-#include <map>
+#include <atomic>
 #include <thread>
-#include <unordered_map>
 #include <condition_variable>
 #include <mutex>
+#include <span>
+#include <string>
 
 #include "Usings.h"
+#include "BookSide.h"
+#include "BookStats.h"
 #include "Order.h"
+#include "PriceLevel.h"
+#include "OrderPool.h"
+#include "OrderRequest.h"
 #include "OrderModify.h"
+#include "OrderBookConfig.h"
+#include "EngineCommand.h"
+#include "ExecutionListener.h"
+#include "ExpiryIndex.h"
+#include "OrderIndex.h"
+#include "SeqLock.h"
+#include "SidePolicy.h"
+#include "TopOfBook.h"
+#include "LevelUpdate.h"
+#include "OrderEvent.h"
 #include "OrderBookLevelInfos.h"
 #include "Trade.h"
 
@@ -22,71 +38,194 @@
 class OrderBook
 {
 private:
-    // Represent Order and it's location in the order book
-    struct OrderEntry
+    // The level the previous order of a batch rested in, so a burst at one price skips the level lookup
+    // Only valid until the next match pass, that is the only thing that can drop a level during a batch
+    struct LevelHint
     {
-        OrderPointer order_ = nullptr;
-        OrderPointers::iterator location_;
+        Side side_ = Side::Buy;
+        Price price_ = 0;
+        PriceLevel *level_ = nullptr;
     };
 
-    // Relevant for FillOrKill orders
-    struct LevelData
+    // Price levels for asks and bids - Price is the key -> Orders at that price
+    // Bids are sorted in descending order (highest price first)
+    // Asks in ascending order (lowest price first)
+    // Prices inside the configured ladder band are array indexed, the rest are kept in a map (see BookSide)
+    BookSide<SidePolicy<Side::Buy>::Compare> bids_;
+    BookSide<SidePolicy<Side::Sell>::Compare> asks_;
+    // Every resting order by id, dense ids by index and the rest hashed (see OrderIndex)
+    // Stop orders waiting for their trigger are in here too, so they can be cancelled and modified like any other
+    OrderIndex orders_;
+
+    // Trigger book: Stop and StopLimit orders not triggered yet, levels keyed by stop price
+    // ordered the way trades reach them - buy stops lowest first (prices rising), sell stops highest first.
+    // A trade only has to look at the front level, releasing what it crossed costs O(triggered)
+    BookSide<less<Price>> buyStops_;
+    BookSide<greater<Price>> sellStops_;
+    // Price of the last fill, InvalidPrice until the book has traded
+    Price lastTradePrice_ = Constants::InvalidPrice;
+    // Stops released by the current command, entered in trigger order once the match pass they came from is done
+    vector<Order *> triggeredStops_;
+    bool releasingStops_ = false;
+    // How far past the best opposite price a market order may sweep, 0 for no limit (see OrderBookConfig)
+    Price marketProtectionTicks_ = 0;
+
+    // GoodForDay and GoodTillTime orders currently resting, by when they go
+    ExpiryIndex expiries_;
+    // Scratch list for the expiry passes, kept to avoid allocating per pass
+    OrderIds expiringIds_;
+
+    // Backing storage for every order the book creates itself (AddOrder(OrderRequest), ModifyOrder)
+    OrderPool pool_;
+
+    // Where acks/fills/cancels go as they happen
+    ExecutionListener listener_;
+    // Set only while a Trades returning call (AddOrder, ModifyOrder) is collecting
+    Trades *collectedTrades_ = nullptr;
+
+    // Levels changed by the command in progress, turned into LevelUpdates when it completes
+    // Only filled while a listener wants level updates
+    struct TouchedLevel
     {
-        Quantity quantity_{};
-        Quantity count_{};
-
-        // Events that affect the level data
-        enum class Action
-        {
-            Add,
-            Remove,
-            Match,
-        };
+        Side side_;
+        Price price_;
+        // Whether the level was there before this change, a level that comes and goes within one command is never reported
+        bool existed_;
     };
+    vector<TouchedLevel> touchedLevels_;
+    vector<LevelUpdate> levelUpdates_;
+    // Public entry points nest (modify = cancel + add),
+    // only the outermost one flushes (and is timed)
+    int commandScopeDepth_ = 0;
+    class CommandScope;
 
-    // Meta data for each price level in the order book(useful for FillOrKill orders)
-    unordered_map<Price, LevelData> data_;
+    // Top levels republished as each outermost command completes, for readers on other threads
+    size_t publishedLevels_ = 0;
+    // Built in place and kept between commands, so a publish only writes the rows in use
+    TopOfBook publishing_;
+    SeqLock<TopOfBook> topOfBook_;
 
-    // Maps for asks and bids - sorting based on price so Price is the key -> Order
-    // Bids are sorted in descending order (highest price first)
-    // Asks in ascending order (lowest price first)
-    map<Price, OrderPointers, greater<Price>> bids_;
-    map<Price, OrderPointers, less<Price>> asks_;
-    unordered_map<OrderId, OrderEntry> orders_;
+    // Sequence number of the last L3 event, stays 0 unless the feed is compiled in
+    uint64_t orderEventSequence_ = 0;
 
-    // Background thread that keeps running whole day at the end it prunes the GoodForDay orders
-    thread ordersPruneThread_;
     mutable mutex ordersMutex_;
     condition_variable shutDownConditionVariable_;
     atomic<bool> shutDown_{false};
+    // Set when an order arrives that expires before the time the prune thread is sleeping until
+    atomic<bool> expiryRescheduled_{false};
+    // Background thread that expires GoodTillTime orders as they come due and GoodForDay orders at the close
+    // Declared after everything it touches so it never starts before they are constructed
+    thread ordersPruneThread_;
 
-    // APIs that affect the state of the order book on specific events
-    void onOrderCancelled(OrderPointer order);
-    void onOrderAdded(OrderPointer order);
-    void onOrderMatched(Price price, Quantity quantity, bool isFullFilled);
-    void updateLevelData(Price price, Quantity quantity, LevelData::Action action);
-
-    // Function to prune GoodForDay orders at the end of the day
-    void CancelOrders(OrderIds orderIds);
     void CancelOrderInternal(OrderId orderId);
+    void ReduceOrderInternal(Order *order, Quantity quantity);
+    void RemoveFilledOrder(OrderId orderId);
+    void ReleaseOrder(const OrderEntry &entry);
+    void AddOrderInternal(OrderEntry entry, LevelHint *hint = nullptr);
+    template <Side S>
+    void AddOrderInternal(OrderEntry &&entry, LevelHint *hint);
+    template <Side S>
+    void UnlinkOrder(Order *order);
+    void SubmitSharedOrder(OrderPointer order);
+
+    void EmitAccepted(OrderId orderId);
+    void EmitRejected(OrderId orderId, RejectReason reason);
+    void EmitTrade(const Trade &trade);
+    void EmitCancelled(OrderId orderId, Quantity remainingQuantity);
+    void EmitReduced(OrderId orderId, Quantity remainingQuantity);
+    void EmitOrderEvent(OrderEventType type, const Order &order, Quantity quantity, uint32_t queuePosition);
+    void TouchLevel(Side side, Price price, bool existed = true);
+    void FlushLevelUpdates();
+    void PublishTopOfBook();
+    template <typename Submit>
+    Trades CollectTrades(Submit &&submit);
 
-    bool canFullyFill(Side side, Price price, Quantity quantity) const;
-    bool canMatch(Side side, Price price) const;
-    void PruneGoodForDayOrders();
-    Trades MatchOrders();
+    // bids_ or asks_, picked at compile time
+    template <Side S>
+    auto &LevelsOf();
+    template <Side S>
+    const auto &LevelsOf() const;
+    template <Side S>
+    bool canFullyFill(Price price, Quantity quantity) const;
+    template <Side S>
+    bool canMatch(Price price) const;
+    void PruneExpiredOrders();
+    void TrackExpiry(Order *order);
+    // Same with ordersMutex_ already held
+    void TrackExpiryLocked(Order *order);
+    bool StopTriggered(const Order &order) const;
+    void RestStopOrder(OrderEntry entry);
+    void RemoveStopOrder(Order *order);
+    void CollectTriggeredStops(Price tradePrice);
+    void ReleaseTriggeredStops();
+    template <Side Aggressor>
+    void MatchOrders();
+    template <Side S>
+    Price MarketLimit() const;
+    template <Side S>
+    void SweepOrder(OrderEntry &&entry, Price limit);
 
 public:
     OrderBook();
+    explicit OrderBook(const OrderBookConfig &config);
     OrderBook(const OrderBook &) = delete;
     void operator=(const OrderBook &) = delete;
     OrderBook(OrderBook &&) = delete;
     void operator=(OrderBook &&) = delete;
     ~OrderBook();
 
+    // Every ack, fill and cancel is reported to the listener as it happens
+    void SetExecutionListener(ExecutionListener listener);
+
     /*Add, Modify, Remove Order functions*/
+    // Results only go to the execution listener - nothing is allocated per call
+    void SubmitOrder(const OrderRequest &request);
+    void SubmitModify(const OrderModify &order);
+    // Add / cancel / modify from a queued or journaled command
+    void SubmitCommand(const EngineCommand &command);
+    // Same operations, additionally returning this call's trades as a vector
     Trades AddOrder(OrderPointer order);
+    Trades AddOrder(const OrderRequest &request);
     void CancelOrder(OrderId orderId);
     Trades ModifyOrder(OrderModify order);
+
+    // Bursts: same events in the same order as submitting them one by one,
+    // with the per call work (map growth, level lookups, the Trades vector, the lock) done once per batch
+    void SubmitOrders(span<const OrderRequest> requests);
+    Trades AddOrders(span<const OrderRequest> requests);
+    void CancelOrders(span<const OrderId> orderIds);
+    // Resting orders, stop orders waiting for their trigger included
     size_t Size() const;
+    // Price of the last trade, Constants::InvalidPrice before the first one
+    Price GetLastTradePrice() const;
     OrderBookLevelInfos GetOrderBookLevelInfos() const;
+    size_t GetTopLevels(Side side, size_t n, LevelInfo *out) const;
+    // Copy of the top levels as of the last completed command, safe to call from any thread while another one
+    // drives the book. Never blocks the book: a reader that overlaps a publish just copies again
+    // Empty (sequence_ 0) unless OrderBookConfig::publishedLevels_ is set
+    TopOfBook GetTopOfBook() const;
+    // Hash of every level and every order in it in queue order (id, remaining quantity), the waiting stops
+    // included, and the last trade price. Two books with equal checksums hold the same queues and trigger
+    // the same stops, for comparing runs of different builds
+    uint64_t GetStateChecksum() const;
+
+    // Expiry, only needed from outside when the book runs without its prune thread
+    // Both work from the expiry index (no scan of the book) and take the lock one slice at a time
+    static constexpr size_t ExpirySliceOrders = 256;
+    // End of day: every GoodForDay order
+    void CancelGoodForDayOrders();
+    // GoodTillTime orders with an expiry at or before now, at most maxOrders of them (earliest first)
+    // Returns how many were cancelled, maxOrders means there may be more due
+    size_t ExpireOrders(ExpiryTime now, size_t maxOrders = ExpirySliceOrders);
+    // The ids the two above would cancel next, without cancelling them
+    // For an owner that has to journal each cancel before the book applies it (CancelOrders)
+    void CollectGoodForDayOrders(size_t maxOrders, OrderIds &orderIds) const;
+    void CollectExpiredOrders(ExpiryTime now, size_t maxOrders, OrderIds &orderIds) const;
+
+    // Every resting order, level by level in queue order, to a versioned binary file (see Snapshot.h)
+    // journalSequence records which journal record the snapshot is up to date with
+    void SaveSnapshot(const string &path, uint64_t journalSequence = 0) const;
+    // Rebuilds an empty book straight from a mapped snapshot - no admission or matching per order
+    // Returns the snapshot's journal sequence. Throws runtime_error for a bad file (the book stays empty)
+    uint64_t LoadSnapshot(const string &path);
 };
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Usings.h"
+
+// Construction time settings for an OrderBook
+struct OrderBookConfig
+{
+    // Price ladder band: levels for prices in [ladderMinPrice_, ladderMinPrice_ + ladderLevels_)
+    // are stored in a flat array per side (O(1) lookup, no allocation when a level appears)
+    // Prices outside the band fall back to the map. 0 levels keeps the map only book
+    Price ladderMinPrice_ = 0;
+    size_t ladderLevels_ = 0;
+
+    // Order ids in [0, denseOrderIds_) are looked up by index in a flat table instead of being hashed
+    // Worth it when ids are small and handed out in sequence, costs 24 bytes per id up front. 0 hashes every id
+    size_t denseOrderIds_ = 0;
+
+    // Orders to pre-allocate in the pool so even the first ones don't hit the heap
+    size_t orderPoolReserve_ = 0;
+
+    // Levels per side copied into the published TopOfBook after every command (capped at TopOfBook::MaxLevels)
+    // so other threads can read the top of the book without a lock (GetTopOfBook). 0 publishes nothing
+    size_t publishedLevels_ = 0;
+
+    // Market order protection: a market order trades at most this many ticks past the best opposite price
+    // it arrived to, whatever is left at that point is cancelled instead of walking further. 0 sweeps without a limit
+    size_t marketProtectionTicks_ = 0;
+
+    // Background thread that cancels GoodForDay orders at market close
+    // Turn it off when a single thread owns the book (MatchingEngine) - that owner calls
+    // CancelGoodForDayOrders() itself so nothing else ever touches the book
+    bool startPruneThread_ = true;
+};
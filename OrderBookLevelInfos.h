@@ -1,5 +1,7 @@
 #pragma once
 
+#include <utility>
+
 #include "LevelInfo.h"
 
 // Class to represent the order book level information
@@ -8,10 +10,10 @@
 class OrderBookLevelInfos
 {
 public:
-    OrderBookLevelInfos(const LevelInfos &bids, const LevelInfos &asks)
+    OrderBookLevelInfos(LevelInfos bids, LevelInfos asks)
     {
-        bids_ = bids;
-        asks_ = asks;
+        bids_ = std::move(bids);
+        asks_ = std::move(asks);
     }
 
     const LevelInfos &GetBids() const { return bids_; }
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Side.h"
+#include "Usings.h"
+
+// L3 (order by order) feed, compiled in only with -DORDERBOOK_L3_FEED=1 (CMake option ORDERBOOK_L3_FEED)
+// When it is off the book doesn't even build the events, there is nothing left to pay at runtime
+#ifndef ORDERBOOK_L3_FEED
+#define ORDERBOOK_L3_FEED 0
+#endif
+inline constexpr bool OrderEventsEnabled = ORDERBOOK_L3_FEED != 0;
+
+enum class OrderEventType : uint8_t
+{
+    Add,     // Order joined the back of its level
+    Reduce,  // Order shrank in place without trading, quantity_ is the reduction
+    Execute, // Resting order traded, quantity_ is the fill
+    Delete,  // Order left the book without trading, quantity_ is what was still open
+};
+
+// One L3 event, fixed 32 bytes with explicit widths so it can be copied straight into a ring or onto the wire
+struct OrderEvent
+{
+    uint64_t sequence_; // Per book, starts at 1 and goes up by one per event
+    int32_t orderId_;
+    int32_t price_;
+    int32_t quantity_;
+    int32_t remainingQuantity_; // Still open after the event
+    // Orders ahead of it in its level: where an Add joined, always 0 for Execute (the front trades first)
+    // Delete and Reduce carry NoQueuePosition, finding it would mean walking the level
+    uint32_t queuePosition_;
+    OrderEventType type_;
+    uint8_t side_; // a Side
+    uint8_t reserved_[2];
+
+    Side GetSide() const { return static_cast<Side>(side_); }
+
+    static constexpr uint32_t NoQueuePosition = UINT32_MAX;
+};
+static_assert(sizeof(OrderEvent) == 32);
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Order.h"
+#include "Usings.h"
+
+// Represent Order and it's location in the order book
+// The Order* is enough to find it in its level (intrusive links) so no iterator is needed
+struct OrderEntry
+{
+    Order *order_ = nullptr;
+    // Only set for orders added through AddOrder(OrderPointer) - keeps the caller's object alive while it rests
+    // Pooled orders leave it empty and go back to the book's pool when they leave the book
+    OrderPointer owner_ = nullptr;
+};
+
+// OrderId -> OrderEntry for every resting order, a single probe per lookup, insert or erase
+// Two storages behind the same API, like BookSide's ladder and overflow:
+//  - Dense: ids in [0, denseIds) index a flat table directly, for feeds that hand out small sequential ids.
+//  - Hashed: every other id goes to an open addressing table (linear probing, power of two size,
+//    never more than half full). Erasing shifts the rest of the probe run back into the hole instead of
+//    leaving a tombstone, so runs stay short however many cancels go through it.
+// A slot with a null order_ is empty.
+class OrderIndex
+{
+private:
+    struct Slot
+    {
+        OrderId orderId_ = 0;
+        OrderEntry entry_;
+    };
+
+    static constexpr size_t MinSlots = 16;
+
+    vector<OrderEntry> dense_;
+    size_t denseCount_ = 0;
+
+    vector<Slot> slots_;
+    size_t mask_ = 0;
+    unsigned shift_ = 64;
+    size_t hashedCount_ = 0;
+
+    static uint64_t Key(OrderId orderId) { return static_cast<uint32_t>(orderId); }
+    bool InDense(OrderId orderId) const { return Key(orderId) < dense_.size(); }
+
+    // Fibonacci hashing: the top bits of the product, sequential ids land far apart
+    size_t Home(OrderId orderId) const { return static_cast<size_t>((Key(orderId) * 0x9E3779B97F4A7C15ULL) >> shift_); }
+
+    // Slot holding orderId, or the empty slot that ends its probe run
+    size_t Probe(OrderId orderId) const
+    {
+        size_t index = Home(orderId);
+        while (slots_[index].entry_.order_ && slots_[index].orderId_ != orderId)
+            index = (index + 1) & mask_;
+        return index;
+    }
+
+    void Rehash(size_t slotCount)
+    {
+        vector<Slot> old = std::move(slots_);
+        slots_ = vector<Slot>(slotCount);
+        mask_ = slotCount - 1;
+        shift_ = 64 - static_cast<unsigned>(countr_zero(slotCount));
+        for (Slot &slot : old)
+            if (slot.entry_.order_)
+                slots_[Probe(slot.orderId_)] = std::move(slot);
+    }
+
+public:
+    OrderIndex() = default;
+    OrderIndex(const OrderIndex &) = delete;
+    OrderIndex &operator=(const OrderIndex &) = delete;
+
+    // Ids in [0, denseIds) use the flat table, everything else the hash table (0 hashes every id)
+    // Must be called while the index is empty
+    void ConfigureDense(size_t denseIds)
+    {
+        if (!empty())
+            throw logic_error("Dense order ids can only be configured on an empty index");
+        dense_ = vector<OrderEntry>(denseIds);
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t size() const { return denseCount_ + hashedCount_; }
+    bool IsDense(OrderId orderId) const { return InDense(orderId); }
+    size_t HashedSize() const { return hashedCount_; }
+    // Hashed ids that fit before the table grows
+    size_t HashedCapacity() const { return slots_.size() / 2; }
+
+    // Room for count hashed ids without growing (dense ids never need any)
+    void reserve(size_t count)
+    {
+        if (2 * count > slots_.size())
+            Rehash(bit_ceil(max(2 * count, MinSlots)));
+    }
+
+    // Room for the hashed ids among a burst of requests (anything with an orderId_) on top of those already in
+    template <typename Requests>
+    void ReserveFor(const Requests &requests)
+    {
+        size_t count = hashedCount_;
+        for (const auto &request : requests)
+            count += !InDense(request.orderId_);
+        reserve(count);
+    }
+
+    OrderEntry *Find(OrderId orderId)
+    {
+        if (InDense(orderId))
+        {
+            OrderEntry &entry = dense_[Key(orderId)];
+            return entry.order_ ? &entry : nullptr;
+        }
+        if (hashedCount_ == 0)
+            return nullptr;
+        Slot &slot = slots_[Probe(orderId)];
+        return slot.entry_.order_ ? &slot.entry_ : nullptr;
+    }
+
+    const OrderEntry *Find(OrderId orderId) const { return const_cast<OrderIndex *>(this)->Find(orderId); }
+    bool contains(OrderId orderId) const { return Find(orderId) != nullptr; }
+
+    // False, leaving entry alone, when orderId is already there
+    bool Insert(OrderId orderId, OrderEntry &&entry)
+    {
+        if (InDense(orderId))
+        {
+            OrderEntry &slot = dense_[Key(orderId)];
+            if (slot.order_)
+                return false;
+            slot = std::move(entry);
+            ++denseCount_;
+            return true;
+        }
+
+        if (2 * (hashedCount_ + 1) > slots_.size())
+            Rehash(max(2 * slots_.size(), MinSlots));
+        Slot &slot = slots_[Probe(orderId)];
+        if (slot.entry_.order_)
+            return false;
+        slot.orderId_ = orderId;
+        slot.entry_ = std::move(entry);
+        ++hashedCount_;
+        return true;
+    }
+
+    // Moves the entry for orderId into entry and drops it from the index, false when it isn't there
+    bool Extract(OrderId orderId, OrderEntry &entry)
+    {
+        if (InDense(orderId))
+        {
+            OrderEntry &slot = dense_[Key(orderId)];
+            if (!slot.order_)
+                return false;
+            entry = std::exchange(slot, OrderEntry{});
+            --denseCount_;
+            return true;
+        }
+
+        if (hashedCount_ == 0)
+            return false;
+        size_t hole = Probe(orderId);
+        if (!slots_[hole].entry_.order_)
+            return false;
+        entry = std::move(slots_[hole].entry_);
+
+        // Backward shift: a later entry of the run moves into the hole unless that would put it before its home
+        for (size_t index = (hole + 1) & mask_; slots_[index].entry_.order_; index = (index + 1) & mask_)
+        {
+            const size_t home = Home(slots_[index].orderId_);
+            if (((index - home) & mask_) >= ((index - hole) & mask_))
+            {
+                slots_[hole] = std::move(slots_[index]);
+                hole = index;
+            }
+        }
+        slots_[hole] = Slot{};
+        --hashedCount_;
+        return true;
+    }
+
+    // fn(OrderId, OrderEntry &) for every entry, in no particular order
+    template <typename Fn>
+    void ForEach(Fn &&fn)
+    {
+        for (size_t index = 0; index < dense_.size() && denseCount_ > 0; ++index)
+            if (dense_[index].order_)
+                fn(static_cast<OrderId>(index), dense_[index]);
+        if (hashedCount_ > 0)
+            for (Slot &slot : slots_)
+                if (slot.entry_.order_)
+                    fn(slot.orderId_, slot.entry_);
+    }
+
+    void clear()
+    {
+        dense_.assign(dense_.size(), OrderEntry{});
+        denseCount_ = 0;
+        slots_.assign(slots_.size(), Slot{});
+        hashedCount_ = 0;
+    }
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+
+#include "Order.h"
+
+// FIFO of the orders resting at a single price level
+// The prev/next links live inside Order itself, so:
+//  - push_back/pop_front never allocate (unlike a list<OrderPointer> node per order)
+//  - erase is O(1) with nothing but the Order* stored in the orders map
+class OrderList
+{
+private:
+    Order *head_ = nullptr;
+    Order *tail_ = nullptr;
+    size_t size_ = 0;
+
+public:
+    class const_iterator
+    {
+    private:
+        const Order *current_ = nullptr;
+
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = const Order *;
+        using difference_type = ptrdiff_t;
+        using pointer = const Order *const *;
+        using reference = const Order *;
+
+        const_iterator() = default;
+        explicit const_iterator(const Order *current) : current_{current} {}
+
+        reference operator*() const { return current_; }
+        const_iterator &operator++()
+        {
+            current_ = current_->next_;
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+        bool operator==(const const_iterator &other) const { return current_ == other.current_; }
+        bool operator!=(const const_iterator &other) const { return current_ != other.current_; }
+    };
+
+    OrderList() = default;
+    // Orders point back into the list, copying it would leave two heads for one chain
+    OrderList(const OrderList &) = delete;
+    OrderList &operator=(const OrderList &) = delete;
+    OrderList(OrderList &&other) noexcept
+        : head_{other.head_}, tail_{other.tail_}, size_{other.size_}
+    {
+        other.head_ = other.tail_ = nullptr;
+        other.size_ = 0;
+    }
+    OrderList &operator=(OrderList &&other) noexcept
+    {
+        head_ = other.head_;
+        tail_ = other.tail_;
+        size_ = other.size_;
+        other.head_ = other.tail_ = nullptr;
+        other.size_ = 0;
+        return *this;
+    }
+
+    bool empty() const { return head_ == nullptr; }
+    size_t size() const { return size_; }
+    Order *front() const { return head_; }
+    Order *back() const { return tail_; }
+    // Same interface as LevelQueue, here the quantity is only kept in the order itself
+    Quantity FrontQuantity() const { return head_->GetRemainingQuantity(); }
+
+    const_iterator begin() const { return const_iterator{head_}; }
+    const_iterator end() const { return const_iterator{}; }
+
+    // Time priority: new orders always join at the back
+    void push_back(Order *order)
+    {
+        order->prev_ = tail_;
+        order->next_ = nullptr;
+        if (tail_)
+            tail_->next_ = order;
+        else
+            head_ = order;
+        tail_ = order;
+        ++size_;
+    }
+
+    void pop_front() { erase(head_); }
+
+    // Unlinks an order from anywhere in the queue (cancel in the middle of the level)
+    void erase(Order *order)
+    {
+        if (order->prev_)
+            order->prev_->next_ = order->next_;
+        else
+            head_ = order->next_;
+
+        if (order->next_)
+            order->next_->prev_ = order->prev_;
+        else
+            tail_ = order->prev_;
+
+        order->prev_ = order->next_ = nullptr;
+        --size_;
+    }
+
+    // Nothing to keep in step, see FrontQuantity
+    void Reduce(const Order *, Quantity) {}
+};
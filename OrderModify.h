@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Order.h"
+#include "OrderRequest.h"
 
 class OrderModify
 {
@@ -29,4 +30,11 @@ public:
     {
         return make_shared<Order>(type, GetOrderId(), GetSide(), GetPrice(), GetQuantity());
     }
+
+    // Allocation free variant used by OrderBook::ModifyOrder, the book builds the order in its own pool
+    // A modified GoodTillTime order keeps its expiry and a stop order its stop price
+    OrderRequest ToOrderRequest(OrderType type, ExpiryTime expiry = {}, Price stopPrice = 0) const
+    {
+        return OrderRequest{type, GetOrderId(), GetSide(), GetPrice(), GetQuantity(), expiry, stopPrice};
+    }
 };
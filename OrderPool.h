@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "BookStats.h"
+#include "Order.h"
+
+// Slab backed storage for the orders the book owns
+// Slots are carved out of fixed size slabs and recycled through a free list,
+// so once the book has reached its high water mark Acquire/Release never touch the heap.
+// Addresses are stable for the lifetime of the pool which is what lets OrderList link orders intrusively.
+class OrderPool
+{
+private:
+    struct Slot
+    {
+        alignas(Order) unsigned char bytes_[sizeof(Order)];
+    };
+
+    size_t slabSize_;
+    vector<unique_ptr<Slot[]>> slabs_;
+    vector<Order *> freeSlots_;
+
+    void AddSlab()
+    {
+        slabs_.emplace_back(new Slot[slabSize_]);
+        RecordBookAllocation();
+        // Reserve for every slot we own so Release never has to grow the free list
+        freeSlots_.reserve(slabs_.size() * slabSize_);
+
+        auto &slab = slabs_.back();
+        // Push in reverse so slots are handed out in address order
+        for (size_t i = slabSize_; i > 0; --i)
+        {
+            freeSlots_.push_back(reinterpret_cast<Order *>(slab[i - 1].bytes_));
+        }
+    }
+
+public:
+    static constexpr size_t DefaultSlabSize = 4096;
+
+    explicit OrderPool(size_t slabSize = DefaultSlabSize) : slabSize_{slabSize > 0 ? slabSize : 1} {}
+    OrderPool(const OrderPool &) = delete;
+    OrderPool &operator=(const OrderPool &) = delete;
+
+    // Pre-size the pool so the first `capacity` orders don't allocate either
+    void Reserve(size_t capacity)
+    {
+        while (Capacity() < capacity)
+            AddSlab();
+    }
+
+    template <typename... Args>
+    Order *Acquire(Args &&...args)
+    {
+        if (freeSlots_.empty())
+            AddSlab();
+
+        Order *slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        return new (slot) Order(std::forward<Args>(args)...);
+    }
+
+    void Release(Order *order)
+    {
+        order->~Order();
+        freeSlots_.push_back(order);
+    }
+
+    size_t Capacity() const { return slabs_.size() * slabSize_; }
+    size_t InUse() const { return Capacity() - freeSlots_.size(); }
+};
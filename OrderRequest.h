@@ -0,0 +1,21 @@
+#pragma once
+
+#include "OrderType.h"
+#include "Side.h"
+#include "Usings.h"
+
+// Plain description of a new order
+// OrderBook::AddOrder(const OrderRequest &) builds the Order inside the book's own pool,
+// so the caller never has to heap allocate an Order just to submit it
+struct OrderRequest
+{
+    OrderType orderType_;
+    OrderId orderId_;
+    Side side_;
+    Price price_;
+    Quantity quantity_;
+    // Only read for GoodTillTime
+    ExpiryTime expiry_{};
+    // Only read for Stop and StopLimit
+    Price stopPrice_ = 0;
+};
@@ -2,12 +2,18 @@
 
 /* Enum class for OrderType
  This enum class defines the types of orders that can be placed in a trading system.
- It includes 5 types: GoodTillCancel, FillAndKill, Market, GoodForDay, and FillOrKill.
+ It includes 8 types: GoodTillCancel, FillAndKill, Market, GoodForDay, FillOrKill, GoodTillTime, Stop and StopLimit.
  - GoodTillCancel orders remain active until they are either filled or canceled.
  - FillAndKill orders are executed immediately and any unfilled portion is canceled.
  - FillOrKill orders are executed in whole i.e either fill 100% or cancel the order.
  - Market orders are executed at the best available price in the market or at market price (I just want to buy or sell anyhow)
+   walking as many levels as needed (OrderBookConfig::marketProtectionTicks_ can cap how far), the rest is canceled.
  - GoodForDay orders are valid for the current trading day and will be canceled at the end of the day if not filled.
+ - GoodTillTime orders rest until the expiry time they carry (OrderRequest::expiry_), a good till date order
+   is one whose expiry is that day's market close.
+ - Stop and StopLimit orders wait off the book until a trade prints at or through their stop price
+   (OrderRequest::stopPrice_, at or above it for a buy, at or below for a sell). Then a Stop order goes in
+   as a Market order and a StopLimit order as a GoodTillCancel order at its price.
 */
 enum class OrderType
 {
@@ -15,5 +21,15 @@ enum class OrderType
     FillAndKill,
     Market,
     GoodForDay,
-    FillOrKill
-};
\ No newline at end of file
+    FillOrKill,
+    GoodTillTime,
+    Stop,
+    StopLimit,
+};
+
+inline bool IsStopType(OrderType type) { return type == OrderType::Stop || type == OrderType::StopLimit; }
+// Orders that trade on arrival or not at all, they never rest in the book
+inline bool IsImmediateType(OrderType type)
+{
+    return type == OrderType::Market || type == OrderType::FillAndKill || type == OrderType::FillOrKill;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <type_traits>
+
+#include "LevelQueue.h"
+#include "OrderList.h"
+#include "Usings.h"
+
+// How a level holds its queue, picked with -DORDERBOOK_SOA_LEVELS=1 (CMake option ORDERBOOK_SOA_LEVELS)
+// Off: OrderList, links inside the orders. On: LevelQueue, contiguous Order* and quantity arrays
+#ifndef ORDERBOOK_SOA_LEVELS
+#define ORDERBOOK_SOA_LEVELS 0
+#endif
+inline constexpr bool SoaLevelsEnabled = ORDERBOOK_SOA_LEVELS != 0;
+
+// All the orders resting at one price plus their running totals
+// quantity_ is kept in step with every add/remove/fill so depth queries read it directly
+// instead of summing the orders (the count is the FIFO's own size)
+class PriceLevel
+{
+public:
+    using Orders = conditional_t<SoaLevelsEnabled, LevelQueue, OrderList>;
+
+private:
+    Orders orders_;
+    Quantity quantity_ = 0;
+
+public:
+    PriceLevel() = default;
+    PriceLevel(PriceLevel &&) = default;
+    PriceLevel &operator=(PriceLevel &&) = default;
+
+    bool empty() const { return orders_.empty(); }
+    size_t size() const { return orders_.size(); }
+    Order *front() const { return orders_.front(); }
+    const Orders &GetOrders() const { return orders_; }
+
+    // Remaining quantity of the order at the front, from the quantity array when there is one
+    Quantity FrontQuantity() const { return orders_.FrontQuantity(); }
+
+    // Total remaining quantity and number of orders at this price
+    Quantity GetQuantity() const { return quantity_; }
+    Quantity GetOrderCount() const { return static_cast<Quantity>(orders_.size()); }
+
+    void push_back(Order *order)
+    {
+        orders_.push_back(order);
+        quantity_ += order->GetRemainingQuantity();
+    }
+
+    void pop_front()
+    {
+        quantity_ -= orders_.FrontQuantity();
+        orders_.pop_front();
+    }
+
+    void erase(Order *order)
+    {
+        quantity_ -= order->GetRemainingQuantity();
+        orders_.erase(order);
+    }
+
+    // Fill an order resting here, going through the level keeps quantity_ right
+    void Fill(Order *order, Quantity quantity)
+    {
+        order->Fill(quantity);
+        orders_.Reduce(order, quantity);
+        quantity_ -= quantity;
+    }
+
+    // Shrink an order resting here without moving it in the queue
+    void Reduce(Order *order, Quantity quantity)
+    {
+        order->Reduce(quantity);
+        orders_.Reduce(order, quantity);
+        quantity_ -= quantity;
+    }
+};
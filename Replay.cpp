@@ -0,0 +1,220 @@
+#include "Replay.h"
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#include "OrderBook.h"
+
+namespace
+{
+    // The last one (expiry or stop price) is optional
+    constexpr size_t CsvFields = 8;
+
+    template <typename T>
+    bool ParseNumber(string_view field, T &value)
+    {
+        if (field.empty())
+        {
+            value = 0;
+            return true;
+        }
+        const auto [end, error] = from_chars(field.data(), field.data() + field.size(), value);
+        return error == errc{} && end == field.data() + field.size();
+    }
+
+    bool ParseCommandType(string_view field, CommandType &type)
+    {
+        if (field == "Add")
+            type = CommandType::Add;
+        else if (field == "Cancel")
+            type = CommandType::Cancel;
+        else if (field == "Modify")
+            type = CommandType::Modify;
+        else
+            return false;
+        return true;
+    }
+
+    bool ParseOrderType(string_view field, OrderType &type)
+    {
+        constexpr pair<string_view, OrderType> names[] = {
+            {"GoodTillCancel", OrderType::GoodTillCancel},
+            {"FillAndKill", OrderType::FillAndKill},
+            {"Market", OrderType::Market},
+            {"GoodForDay", OrderType::GoodForDay},
+            {"FillOrKill", OrderType::FillOrKill},
+            {"GoodTillTime", OrderType::GoodTillTime},
+            {"Stop", OrderType::Stop},
+            {"StopLimit", OrderType::StopLimit},
+        };
+        if (field.empty())
+        {
+            type = OrderType::GoodTillCancel;
+            return true;
+        }
+        for (const auto &[name, value] : names)
+        {
+            if (field == name)
+            {
+                type = value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ParseSide(string_view field, Side &side)
+    {
+        if (field.empty() || field == "Buy")
+            side = Side::Buy;
+        else if (field == "Sell")
+            side = Side::Sell;
+        else
+            return false;
+        return true;
+    }
+
+    // Counts what the book reports, the replay result carries the totals
+    struct ReplayCounters
+    {
+        uint64_t trades_ = 0;
+        uint64_t rejects_ = 0;
+        uint64_t cancels_ = 0;
+
+        void OnTrade(const Trade &) { ++trades_; }
+        void OnRejected(OrderId, RejectReason) { ++rejects_; }
+        void OnCancelled(OrderId, Quantity) { ++cancels_; }
+    };
+}
+
+ReplaySource::ReplaySource(const string &path)
+    : file_{MappedFile::Open(path, MappedFile::Access::Sequential)},
+      journal_{file_.data(), file_.size()}
+{
+    if (journal_.IsJournal())
+        return;
+    cursor_ = reinterpret_cast<const char *>(file_.data());
+    end_ = cursor_ + file_.size();
+}
+
+bool ReplaySource::Next(ReplayEvent &event)
+{
+    if (!journal_.IsJournal())
+        return NextCsv(event);
+
+    JournalRecord record;
+    if (!journal_.Next(record))
+        return false;
+    event = ReplayEvent{0, record.ToCommand()};
+    return true;
+}
+
+bool ReplaySource::NextCsv(ReplayEvent &event)
+{
+    while (cursor_ != end_)
+    {
+        const char *lineEnd = static_cast<const char *>(memchr(cursor_, '\n', static_cast<size_t>(end_ - cursor_)));
+        if (!lineEnd)
+            lineEnd = end_;
+        string_view line(cursor_, static_cast<size_t>(lineEnd - cursor_));
+        cursor_ = lineEnd == end_ ? end_ : lineEnd + 1;
+        ++line_;
+
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        array<string_view, CsvFields> fields;
+        size_t fieldCount = 0;
+        while (fieldCount < CsvFields)
+        {
+            const size_t comma = line.find(',');
+            fields[fieldCount++] = line.substr(0, comma);
+            if (comma == string_view::npos)
+            {
+                line = {};
+                break;
+            }
+            line.remove_prefix(comma + 1);
+        }
+
+        // Only the first line may be a header
+        if (line_ == 1 && fields[0] == "timestamp_ns")
+            continue;
+
+        EngineCommand &command = event.command_;
+        command = EngineCommand{};
+        int64_t extra = 0;
+        if (fieldCount < CsvFields - 1 || !line.empty() ||
+            fields[0].empty() || !ParseNumber(fields[0], event.timestampNanos_) ||
+            !ParseCommandType(fields[1], command.type_) ||
+            !ParseOrderType(fields[2], command.order_.orderType_) ||
+            fields[3].empty() || !ParseNumber(fields[3], command.order_.orderId_) ||
+            !ParseSide(fields[4], command.order_.side_) ||
+            !ParseNumber(fields[5], command.order_.price_) ||
+            !ParseNumber(fields[6], command.order_.quantity_) ||
+            (fieldCount == CsvFields && !ParseNumber(fields[7], extra)))
+            throw runtime_error("Malformed replay line " + to_string(line_));
+        if (IsStopType(command.order_.orderType_))
+            command.order_.stopPrice_ = static_cast<Price>(extra);
+        else
+            command.order_.expiry_ = ExpiryTime{chrono::seconds{extra}};
+        return true;
+    }
+    return false;
+}
+
+ReplayResult RunReplay(const ReplayConfig &config)
+{
+    using namespace std::chrono;
+
+    ReplaySource source(config.path_);
+    if (config.speed_ < 0 || (config.speed_ > 0 && !source.HasTimestamps()))
+        throw invalid_argument("Paced replay needs a non negative speed and a recording with timestamps");
+
+    OrderBook orderBook(config.book_);
+    ReplayCounters counters;
+    orderBook.SetExecutionListener(MakeExecutionListener(counters));
+
+    ReplayResult result;
+    ReplayEvent event;
+    const auto start = steady_clock::now();
+    bool first = true;
+    uint64_t firstTimestamp = 0;
+    while (source.Next(event))
+    {
+        if (config.speed_ > 0)
+        {
+            if (first)
+                firstTimestamp = event.timestampNanos_;
+            // Commands recorded out of order (or on a clock that went back) go immediately
+            const uint64_t offset = event.timestampNanos_ > firstTimestamp ? event.timestampNanos_ - firstTimestamp : 0;
+            const auto due = start + duration_cast<steady_clock::duration>(duration<double, nano>(static_cast<double>(offset) / config.speed_));
+            // Sleep through long gaps, spin the last stretch so the command goes out on time
+            if (due - steady_clock::now() > milliseconds(1))
+                this_thread::sleep_until(due - microseconds(200));
+            while (steady_clock::now() < due)
+                ;
+        }
+        first = false;
+
+        const auto before = steady_clock::now();
+        orderBook.SubmitCommand(event.command_);
+        const auto after = steady_clock::now();
+        result.latency_.Record(static_cast<uint64_t>(duration_cast<nanoseconds>(after - before).count()));
+        ++result.commands_;
+    }
+    result.elapsed_ = duration_cast<nanoseconds>(steady_clock::now() - start);
+
+    result.trades_ = counters.trades_;
+    result.rejects_ = counters.rejects_;
+    result.cancels_ = counters.cancels_;
+    result.restingOrders_ = orderBook.Size();
+    result.bookChecksum_ = orderBook.GetStateChecksum();
+    return result;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "Usings.h"
+
+// One value written by a single thread and read by any number of others without a lock
+// The writer never waits for readers: it bumps sequence_ to odd, stores the value and bumps it back to even.
+// A reader copies the value between two reads of sequence_ and starts over if a store overlapped the copy.
+// The value is kept as relaxed atomic words so a torn copy is a retry, never a data race.
+template <typename T>
+class SeqLock
+{
+private:
+    static_assert(is_trivially_copyable_v<T> && sizeof(T) % sizeof(uint64_t) == 0);
+    static constexpr size_t Words = sizeof(T) / sizeof(uint64_t);
+    static constexpr size_t CacheLine = 64;
+
+    alignas(CacheLine) atomic<uint64_t> sequence_{0};
+    array<atomic<uint64_t>, Words> words_{};
+
+public:
+    SeqLock() { Store(T{}); }
+    SeqLock(const SeqLock &) = delete;
+    SeqLock &operator=(const SeqLock &) = delete;
+
+    // Only ever called by one thread at a time
+    // Only the first `bytes` of value are written, words past them keep what an earlier Store left there
+    void Store(const T &value, size_t bytes = sizeof(T))
+    {
+        const size_t words = min(Words, (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        const auto *source = reinterpret_cast<const unsigned char *>(&value);
+
+        const uint64_t sequence = sequence_.load(memory_order_relaxed);
+        sequence_.store(sequence + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        for (size_t i = 0; i < words; ++i)
+        {
+            uint64_t word;
+            memcpy(&word, source + i * sizeof(uint64_t), sizeof(word));
+            words_[i].store(word, memory_order_relaxed);
+        }
+        sequence_.store(sequence + 2, memory_order_release);
+    }
+
+    T Load() const
+    {
+        uint64_t words[Words];
+        while (true)
+        {
+            const uint64_t before = sequence_.load(memory_order_acquire);
+            if (before & 1)
+                continue;
+            for (size_t i = 0; i < Words; ++i)
+                words[i] = words_[i].load(memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (sequence_.load(memory_order_relaxed) == before)
+                break;
+        }
+
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+};
@@ -0,0 +1,203 @@
+#include "ShardedEngine.h"
+
+#include <stdexcept>
+
+#include "MarketHours.h"
+#include "ThreadAffinity.h"
+
+namespace
+{
+    OrderBookConfig WithoutPruneThread(OrderBookConfig config)
+    {
+        config.startPruneThread_ = false;
+        return config;
+    }
+
+    // Same back off as MatchingEngine, a worker only spins flat out while it has work
+    void Idle(unsigned &idleSpins)
+    {
+        if (++idleSpins < 64)
+            return;
+        this_thread::yield();
+    }
+}
+
+ShardedEngine::ShardedEngine(const ShardedEngineConfig &config)
+    : symbols_{config.symbols_}
+{
+    if (config.shards_ == 0)
+        throw invalid_argument("ShardedEngine needs at least one shard");
+
+    for (size_t shard = 0; shard < config.shards_; ++shard)
+    {
+        const int cpu = config.firstCpu_ < 0 ? -1 : config.firstCpu_ + static_cast<int>(shard);
+        shards_.push_back(make_unique<Shard>(config.shards_, config, cpu));
+    }
+
+    const OrderBookConfig bookConfig = WithoutPruneThread(config.book_);
+    for (SymbolId symbolId = 0; symbolId < symbols_.size(); ++symbolId)
+    {
+        if (!symbolIds_.emplace(symbols_[symbolId], symbolId).second)
+            throw invalid_argument("Duplicate symbol " + symbols_[symbolId]);
+        ShardFor(symbolId).AddInstrument(bookConfig, symbolId);
+    }
+
+    // Books are all in place, from here on only the workers touch them
+    for (auto &shard : shards_)
+        shard->Start();
+}
+
+ShardedEngine::~ShardedEngine()
+{
+    Stop();
+}
+
+SymbolId ShardedEngine::GetSymbolId(string_view symbol) const
+{
+    auto iterator = symbolIds_.find(string{symbol});
+    if (iterator == symbolIds_.end())
+        throw out_of_range("Unknown symbol " + string{symbol});
+    return iterator->second;
+}
+
+bool ShardedEngine::TrySubmit(SymbolId symbolId, EngineCommand command)
+{
+    command.symbolId_ = symbolId;
+    return ShardFor(symbolId).TrySubmit(command);
+}
+
+void ShardedEngine::Submit(SymbolId symbolId, EngineCommand command)
+{
+    command.symbolId_ = symbolId;
+    Shard &shard = ShardFor(symbolId);
+    while (!shard.TrySubmit(command))
+        this_thread::yield();
+}
+
+void ShardedEngine::Stop()
+{
+    // Signal everyone first so the workers wind down in parallel
+    for (auto &shard : shards_)
+        shard->RequestStop();
+    for (auto &shard : shards_)
+        shard->Stop();
+}
+
+const OrderBook &ShardedEngine::GetOrderBook(SymbolId symbolId) const
+{
+    if (symbolId >= symbols_.size())
+        throw out_of_range("Unknown symbol id");
+    return shards_[symbolId % shards_.size()]->GetOrderBook(symbolId);
+}
+
+ShardedEngine::Shard::Instrument::Instrument(const OrderBookConfig &config, Shard *shard, SymbolId symbolId)
+    : orderBook_{config},
+      reportSink_{shard, symbolId}
+{
+    orderBook_.SetExecutionListener(MakeExecutionListener(reportSink_));
+}
+
+ShardedEngine::Shard::Shard(size_t shardCount, const ShardedEngineConfig &config, int cpu)
+    : shardCount_{shardCount},
+      commands_{config.commandCapacity_},
+      reports_{config.reportCapacity_},
+      cpu_{cpu},
+      nextMarketClose_{NextMarketClose(std::chrono::system_clock::now())}
+{
+}
+
+ShardedEngine::Shard::~Shard()
+{
+    Stop();
+}
+
+void ShardedEngine::Shard::AddInstrument(const OrderBookConfig &config, SymbolId symbolId)
+{
+    instruments_.push_back(make_unique<Instrument>(config, this, symbolId));
+}
+
+void ShardedEngine::Shard::Start()
+{
+    workerThread_ = thread{[this]
+                           { Run(); }};
+}
+
+void ShardedEngine::Shard::Stop()
+{
+    RequestStop();
+    if (workerThread_.joinable())
+        workerThread_.join();
+}
+
+void ShardedEngine::Shard::Run()
+{
+    if (cpu_ >= 0)
+        PinCurrentThread(cpu_);
+
+    constexpr unsigned ClockCheckInterval = 4096;
+    unsigned commandsSinceClockCheck = 0;
+
+    EngineCommand command;
+    unsigned idleSpins = 0;
+    while (true)
+    {
+        if (commands_.TryPop(command))
+        {
+            idleSpins = 0;
+            Apply(command);
+            if (++commandsSinceClockCheck == ClockCheckInterval)
+            {
+                commandsSinceClockCheck = 0;
+                ExpireIfDue();
+            }
+            continue;
+        }
+
+        if (stop_.load(memory_order_acquire))
+        {
+            if (commands_.TryPop(command))
+            {
+                Apply(command);
+                continue;
+            }
+            return;
+        }
+
+        ExpireIfDue();
+        Idle(idleSpins);
+    }
+}
+
+void ShardedEngine::Shard::Apply(const EngineCommand &command)
+{
+    instruments_[command.symbolId_ / shardCount_]->orderBook_.SubmitCommand(command);
+}
+
+void ShardedEngine::Shard::Publish(const ExecutionReport &report)
+{
+    while (!reports_.TryPush(report))
+        this_thread::yield();
+}
+
+// One clock check covers every book of the worker
+// Expiry times are whole seconds, so the books are looked at once per second rather than on every idle spin
+// (an order already due when it arrives waits for the next second), unless a slice left some due ones behind
+void ShardedEngine::Shard::ExpireIfDue()
+{
+    const auto now = std::chrono::system_clock::now();
+    const auto second = std::chrono::floor<std::chrono::seconds>(now);
+    if (second == lastExpiryCheck_ && now < nextMarketClose_)
+        return;
+
+    bool allExpired = true;
+    for (auto &instrument : instruments_)
+        allExpired &= instrument->orderBook_.ExpireOrders(second) < OrderBook::ExpirySliceOrders;
+    if (allExpired)
+        lastExpiryCheck_ = second;
+    if (now < nextMarketClose_)
+        return;
+
+    for (auto &instrument : instruments_)
+        instrument->orderBook_.CancelGoodForDayOrders();
+    nextMarketClose_ = NextMarketClose(now);
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "EngineCommand.h"
+#include "ExecutionReport.h"
+#include "MpscRing.h"
+#include "OrderBook.h"
+
+struct ShardedEngineConfig
+{
+    // One book per symbol, SymbolId i is symbols_[i]
+    vector<string> symbols_;
+    // Used for every book, no book ever starts a prune thread - each worker expires its own books
+    OrderBookConfig book_{};
+    // Number of worker threads, symbols are dealt out round robin (SymbolId % shards_)
+    size_t shards_ = 1;
+    // Per worker, both must be powers of two
+    size_t commandCapacity_ = 1 << 16;
+    size_t reportCapacity_ = 1 << 16;
+    // Worker i is pinned to firstCpu_ + i, -1 leaves them all to the scheduler
+    int firstCpu_ = -1;
+};
+
+// Many instruments over a fixed set of single writer worker threads
+// Instead of one OrderBook (and one prune thread) per symbol, books are partitioned across `shards_` workers.
+// Each worker owns its books outright: it is the only thread that touches them, drains its own command ring
+// and runs end of day expiry for all of them, so workers share nothing and throughput scales with cores.
+// Reports from every worker are collected by one consumer through PollReports.
+class ShardedEngine
+{
+private:
+    class Shard;
+
+    unordered_map<string, SymbolId> symbolIds_;
+    vector<string> symbols_;
+    vector<unique_ptr<Shard>> shards_;
+
+    Shard &ShardFor(SymbolId symbolId) { return *shards_[symbolId % shards_.size()]; }
+
+public:
+    explicit ShardedEngine(const ShardedEngineConfig &config);
+    ShardedEngine(const ShardedEngine &) = delete;
+    ShardedEngine &operator=(const ShardedEngine &) = delete;
+    // Processes whatever is already queued, then stops the workers
+    ~ShardedEngine();
+
+    // Throws out_of_range for a symbol that wasn't configured
+    SymbolId GetSymbolId(string_view symbol) const;
+    const string &GetSymbol(SymbolId symbolId) const { return symbols_.at(symbolId); }
+    size_t SymbolCount() const { return symbols_.size(); }
+    size_t ShardCount() const { return shards_.size(); }
+
+    // Any thread, symbolId must come from GetSymbolId (not checked on this path)
+    // Commands for one symbol from one producer are applied in submit order
+    // TrySubmit fails when that symbol's worker ring is full, Submit waits for room
+    bool TrySubmit(SymbolId symbolId, EngineCommand command);
+    void Submit(SymbolId symbolId, EngineCommand command);
+
+    // Single consumer thread: hands every queued report of every worker to fn, returns how many there were
+    // Reports of one symbol arrive in order, there is no ordering between workers
+    template <typename Fn>
+    size_t PollReports(Fn &&fn);
+
+    // Stops every worker after it has drained its command ring
+    // Afterwards the books can be inspected from the calling thread
+    void Stop();
+    const OrderBook &GetOrderBook(SymbolId symbolId) const;
+};
+
+class ShardedEngine::Shard
+{
+private:
+    // A book plus the sink that stamps its reports with the symbol
+    struct Instrument
+    {
+        struct ReportSink
+        {
+            Shard *shard_;
+            SymbolId symbolId_;
+            void Publish(ExecutionReport report)
+            {
+                report.symbolId_ = symbolId_;
+                shard_->Publish(report);
+            }
+            void OnAccepted(OrderId orderId) { Publish(ExecutionReport::Accepted(orderId)); }
+            void OnRejected(OrderId orderId, RejectReason reason) { Publish(ExecutionReport::Rejected(orderId, reason)); }
+            void OnTrade(const Trade &trade) { Publish(ExecutionReport::Traded(trade)); }
+            void OnCancelled(OrderId orderId, Quantity remaining) { Publish(ExecutionReport::Cancelled(orderId, remaining)); }
+            void OnReduced(OrderId orderId, Quantity remaining) { Publish(ExecutionReport::Reduced(orderId, remaining)); }
+        };
+
+        OrderBook orderBook_;
+        ReportSink reportSink_;
+
+        Instrument(const OrderBookConfig &config, Shard *shard, SymbolId symbolId);
+    };
+
+    size_t shardCount_;
+    // Indexed by SymbolId / shardCount_
+    vector<unique_ptr<Instrument>> instruments_;
+    MpscRing<EngineCommand> commands_;
+    MpscRing<ExecutionReport> reports_;
+    int cpu_;
+
+    // Only the worker thread uses them
+    std::chrono::system_clock::time_point nextMarketClose_;
+    ExpiryTime lastExpiryCheck_{};
+
+    atomic<bool> stop_{false};
+    // Started by Start() once every instrument is in place
+    thread workerThread_;
+
+    void Run();
+    void Apply(const EngineCommand &command);
+    void Publish(const ExecutionReport &report);
+    void ExpireIfDue();
+
+public:
+    Shard(size_t shardCount, const ShardedEngineConfig &config, int cpu);
+    Shard(const Shard &) = delete;
+    Shard &operator=(const Shard &) = delete;
+    ~Shard();
+
+    void AddInstrument(const OrderBookConfig &config, SymbolId symbolId);
+    void Start();
+    // RequestStop only flags the worker, Stop also waits for it
+    void RequestStop() { stop_.store(true, memory_order_release); }
+    void Stop();
+
+    bool TrySubmit(const EngineCommand &command) { return commands_.TryPush(command); }
+    bool TryPollReport(ExecutionReport &report) { return reports_.TryPop(report); }
+    const OrderBook &GetOrderBook(SymbolId symbolId) const { return instruments_[symbolId / shardCount_]->orderBook_; }
+};
+
+template <typename Fn>
+size_t ShardedEngine::PollReports(Fn &&fn)
+{
+    size_t count = 0;
+    ExecutionReport report;
+    for (auto &shard : shards_)
+    {
+        while (shard->TryPollReport(report))
+        {
+            fn(report);
+            ++count;
+        }
+    }
+    return count;
+}
@@ -1,3 +1,5 @@
+#pragma once
+
 // Enum class for Side
 // This enum class defines the sides of a trade in a trading system.
 // It includes two sides: Buy and Sell.
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+
+#include "Side.h"
+#include "Usings.h"
+
+// Everything that differs between the two sides of the book, as compile time constants
+// The matching core is written once against SidePolicy<S> and instantiated for both sides,
+// so the side is decided once per call instead of at every comparison inside it
+template <Side S>
+struct SidePolicy;
+
+template <>
+struct SidePolicy<Side::Buy>
+{
+    static constexpr Side Opposite = Side::Sell;
+    // Priority order of resting buys - highest first
+    using Compare = greater<Price>;
+
+    // Whether price gets to bound coming from this side: a buy at price pays bound or more.
+    // Covers both a limit reaching a resting ask and a trade going through a buy stop's stop price
+    static constexpr bool Reaches(Price price, Price bound) { return price >= bound; }
+};
+
+template <>
+struct SidePolicy<Side::Sell>
+{
+    static constexpr Side Opposite = Side::Buy;
+    // Priority order of resting sells - lowest first
+    using Compare = less<Price>;
+
+    static constexpr bool Reaches(Price price, Price bound) { return price <= bound; }
+};
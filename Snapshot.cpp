@@ -0,0 +1,224 @@
+#include "OrderBook.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+
+#include "MappedFile.h"
+#include "Snapshot.h"
+
+namespace
+{
+    [[noreturn]] void ThrowErrno(const string &what)
+    {
+        throw system_error(errno, generic_category(), what);
+    }
+
+    // Sequential reads out of the mapping, anything past the end means the file is cut short
+    class SnapshotReader
+    {
+    private:
+        const unsigned char *cursor_;
+        const unsigned char *end_;
+
+    public:
+        SnapshotReader(const unsigned char *data, size_t size) : cursor_{data}, end_{data + size} {}
+
+        template <typename T>
+        T Read()
+        {
+            if (static_cast<size_t>(end_ - cursor_) < sizeof(T))
+                throw runtime_error("Snapshot is truncated");
+            T value;
+            memcpy(&value, cursor_, sizeof(T));
+            cursor_ += sizeof(T);
+            return value;
+        }
+
+        bool AtEnd() const { return cursor_ == end_; }
+    };
+
+    template <typename T>
+    unsigned char *Write(unsigned char *cursor, const T &value)
+    {
+        memcpy(cursor, &value, sizeof(T));
+        return cursor + sizeof(T);
+    }
+
+    bool IsRestingType(uint8_t orderType)
+    {
+        // Market, FillAndKill and FillOrKill never rest, triggered stops rest as GoodTillCancel
+        const auto type = static_cast<OrderType>(orderType);
+        return type == OrderType::GoodTillCancel || type == OrderType::GoodForDay || type == OrderType::GoodTillTime;
+    }
+}
+
+// Written to path + ".tmp" and renamed over path once synced, a crash never leaves half a snapshot behind
+void OrderBook::SaveSnapshot(const string &path, uint64_t journalSequence) const
+{
+    std::scoped_lock ordersLock{ordersMutex_};
+
+    const size_t size = sizeof(SnapshotHeader) +
+                        (bids_.size() + asks_.size() + buyStops_.size() + sellStops_.size()) * sizeof(SnapshotLevel) +
+                        orders_.size() * sizeof(SnapshotOrder);
+    const string temporaryPath = path + ".tmp";
+
+    {
+        MappedFile file = MappedFile::Create(temporaryPath, size);
+
+        SnapshotHeader header{};
+        header.magic_ = SnapshotMagic;
+        header.version_ = SnapshotVersion;
+        header.lastTradePrice_ = lastTradePrice_;
+        header.journalSequence_ = journalSequence;
+        header.bidLevelCount_ = bids_.size();
+        header.askLevelCount_ = asks_.size();
+        header.orderCount_ = orders_.size();
+        header.buyStopLevelCount_ = buyStops_.size();
+        header.sellStopLevelCount_ = sellStops_.size();
+        unsigned char *cursor = Write(file.data(), header);
+
+        auto writeLevel = [&](Price price, const PriceLevel &level)
+        {
+            cursor = Write(cursor, SnapshotLevel{price, static_cast<uint32_t>(level.size()), level.GetQuantity()});
+            for (const Order *order : level.GetOrders())
+            {
+                SnapshotOrder record{};
+                record.orderId_ = order->GetOrderId();
+                record.initialQuantity_ = order->GetInitialQuantity();
+                record.remainingQuantity_ = order->GetRemainingQuantity();
+                record.orderType_ = static_cast<uint8_t>(order->GetOrderType());
+                if (IsStopType(order->GetOrderType()))
+                    record.limitPrice_ = order->GetPrice();
+                else
+                    record.expiry_ = order->GetExpiry().time_since_epoch().count();
+                cursor = Write(cursor, record);
+            }
+        };
+        bids_.ForEachLevel(writeLevel);
+        asks_.ForEachLevel(writeLevel);
+        buyStops_.ForEachLevel(writeLevel);
+        sellStops_.ForEachLevel(writeLevel);
+
+        file.Sync();
+    }
+
+    if (::rename(temporaryPath.c_str(), path.c_str()) != 0)
+        ThrowErrno("Cannot move snapshot into place at " + path);
+}
+
+uint64_t OrderBook::LoadSnapshot(const string &path)
+{
+    std::scoped_lock ordersLock{ordersMutex_};
+
+    if (!orders_.empty())
+        throw logic_error("Snapshot can only be loaded into an empty book");
+
+    const MappedFile file = MappedFile::Open(path);
+    SnapshotReader reader(file.data(), file.size());
+
+    const auto header = reader.Read<SnapshotHeader>();
+    if (header.magic_ != SnapshotMagic || header.version_ != SnapshotVersion)
+        throw runtime_error("Snapshot " + path + " has an unknown format");
+
+    // Check the counts against the file before trusting them with an allocation
+    const uint64_t maxLevels = file.size() / sizeof(SnapshotLevel);
+    if (header.bidLevelCount_ > maxLevels || header.askLevelCount_ > maxLevels ||
+        header.buyStopLevelCount_ > maxLevels || header.sellStopLevelCount_ > maxLevels)
+        throw runtime_error("Snapshot " + path + " doesn't match its header");
+    const uint64_t levelCount = header.bidLevelCount_ + header.askLevelCount_ + header.buyStopLevelCount_ + header.sellStopLevelCount_;
+    if (levelCount > maxLevels || header.orderCount_ > file.size() / sizeof(SnapshotOrder) ||
+        sizeof(SnapshotHeader) + levelCount * sizeof(SnapshotLevel) + header.orderCount_ * sizeof(SnapshotOrder) != file.size())
+        throw runtime_error("Snapshot " + path + " doesn't match its header");
+
+    // Everything is allocated once up front, the loop below only links
+    // Dense ids need no room in the index's hash table, so count the others first (a walk over the mapping)
+    size_t hashedOrders = 0;
+    try
+    {
+        SnapshotReader counter = reader;
+        for (uint64_t levelIndex = 0; levelIndex < levelCount; ++levelIndex)
+        {
+            const auto levelRecord = counter.Read<SnapshotLevel>();
+            for (uint32_t i = 0; i < levelRecord.orderCount_; ++i)
+                hashedOrders += !orders_.IsDense(counter.Read<SnapshotOrder>().orderId_);
+        }
+    }
+    catch (const runtime_error &)
+    {
+        // Only a count, the pass below says what is wrong with the file
+    }
+    pool_.Reserve(pool_.InUse() + header.orderCount_);
+    orders_.reserve(hashedOrders);
+
+    // Levels come best first (isBetter is the side's priority order), each strictly worse than the previous
+    // The trigger book's levels are stop prices, its orders carry their own limit price
+    auto loadSide = [&](auto &bookSide, Side side, uint64_t levelCount, auto isBetter, bool stops)
+    {
+        Price previousPrice = 0;
+        for (uint64_t levelIndex = 0; levelIndex < levelCount; ++levelIndex)
+        {
+            const auto levelRecord = reader.Read<SnapshotLevel>();
+            if (levelRecord.orderCount_ == 0 || (levelIndex > 0 && !isBetter(previousPrice, levelRecord.price_)))
+                throw runtime_error("Snapshot " + path + " has levels out of order");
+            previousPrice = levelRecord.price_;
+
+            PriceLevel &level = bookSide.AppendLevel(levelRecord.price_);
+            for (uint32_t i = 0; i < levelRecord.orderCount_; ++i)
+            {
+                const auto orderRecord = reader.Read<SnapshotOrder>();
+                const auto orderType = static_cast<OrderType>(orderRecord.orderType_);
+                if ((stops ? !IsStopType(orderType) : !IsRestingType(orderRecord.orderType_)) || orderRecord.remainingQuantity_ <= 0 ||
+                    orderRecord.remainingQuantity_ > orderRecord.initialQuantity_)
+                    throw runtime_error("Snapshot " + path + " has an invalid order");
+                // Before taking it from the pool, the cleanup below only releases what is in orders_
+                if (orders_.contains(orderRecord.orderId_))
+                    throw runtime_error("Snapshot " + path + " has a duplicate order id");
+
+                Order *order = stops ? pool_.Acquire(orderType, orderRecord.orderId_, side, static_cast<Price>(orderRecord.limitPrice_),
+                                                     orderRecord.initialQuantity_, ExpiryTime{}, levelRecord.price_)
+                                     : pool_.Acquire(orderType, orderRecord.orderId_, side, levelRecord.price_,
+                                                     orderRecord.initialQuantity_, ExpiryTime{chrono::seconds{orderRecord.expiry_}});
+                order->Fill(orderRecord.initialQuantity_ - orderRecord.remainingQuantity_);
+                level.push_back(order);
+                orders_.Insert(orderRecord.orderId_, OrderEntry{order, nullptr});
+                if (ExpiryIndex::Expires(orderType))
+                    TrackExpiryLocked(order);
+            }
+
+            if (level.GetQuantity() != levelRecord.quantity_)
+                throw runtime_error("Snapshot " + path + " level totals don't match its orders");
+        }
+    };
+
+    try
+    {
+        loadSide(bids_, Side::Buy, header.bidLevelCount_, greater<Price>{}, false);
+        loadSide(asks_, Side::Sell, header.askLevelCount_, less<Price>{}, false);
+        loadSide(buyStops_, Side::Buy, header.buyStopLevelCount_, less<Price>{}, true);
+        loadSide(sellStops_, Side::Sell, header.sellStopLevelCount_, greater<Price>{}, true);
+
+        if (!reader.AtEnd() || orders_.size() != header.orderCount_)
+            throw runtime_error("Snapshot " + path + " doesn't match its header");
+        if (!bids_.empty() && !asks_.empty() && bids_.BestPrice() >= asks_.BestPrice())
+            throw runtime_error("Snapshot " + path + " holds a crossed book");
+        lastTradePrice_ = header.lastTradePrice_;
+    }
+    catch (...)
+    {
+        // Leave the book as empty as it was
+        orders_.ForEach([this](OrderId, OrderEntry &entry)
+                        { pool_.Release(entry.order_); });
+        orders_.clear();
+        expiries_.clear();
+        bids_.clear();
+        asks_.clear();
+        buyStops_.clear();
+        sellStops_.clear();
+        throw;
+    }
+
+    PublishTopOfBook();
+    return header.journalSequence_;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+// On disk layout of an OrderBook snapshot (OrderBook::SaveSnapshot / LoadSnapshot)
+//
+//   SnapshotHeader
+//   bids, best first: SnapshotLevel, then its orders front to back as SnapshotOrder
+//   asks, best first: same
+//   buy stops, lowest stop price first: SnapshotLevel keyed by stop price, then its orders in trigger order
+//   sell stops, highest stop price first: same
+//
+// Everything is fixed width and little endian as written, so loading is a walk over the mapped file.
+// The level totals are stored too and checked against the orders while loading.
+struct SnapshotHeader
+{
+    uint64_t magic_;
+    uint32_t version_;
+    // Constants::InvalidPrice when the book hasn't traded yet
+    int32_t lastTradePrice_;
+    // Last journal record already reflected in the snapshot, replay continues after it
+    uint64_t journalSequence_;
+    uint64_t bidLevelCount_;
+    uint64_t askLevelCount_;
+    // Every order, stops included
+    uint64_t orderCount_;
+    uint64_t buyStopLevelCount_;
+    uint64_t sellStopLevelCount_;
+};
+static_assert(sizeof(SnapshotHeader) == 64);
+
+struct SnapshotLevel
+{
+    int32_t price_;
+    uint32_t orderCount_;
+    int64_t quantity_;
+};
+static_assert(sizeof(SnapshotLevel) == 16);
+
+struct SnapshotOrder
+{
+    int32_t orderId_;
+    int32_t initialQuantity_;
+    int32_t remainingQuantity_;
+    uint8_t orderType_;
+    uint8_t reserved_[3];
+    union
+    {
+        // GoodTillTime only: seconds since the epoch
+        int64_t expiry_;
+        // Stop orders (the level is the stop price): the price a StopLimit goes in at
+        int64_t limitPrice_;
+    };
+};
+static_assert(sizeof(SnapshotOrder) == 24);
+
+inline constexpr uint64_t SnapshotMagic = 0x31505348534B424FULL; // "OBKSHSP1"
+inline constexpr uint32_t SnapshotVersion = 3;
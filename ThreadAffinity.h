@@ -0,0 +1,24 @@
+#pragma once
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Pins the calling thread to one CPU so a hot loop keeps its caches and isn't migrated
+// Returns false where pinning isn't supported (non Linux) or the CPU doesn't exist, the thread just stays unpinned
+inline bool PinCurrentThread(int cpu)
+{
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
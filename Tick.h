@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cmath>
+
+#include "Usings.h"
+
+// Conversion between decimal prices and the integer ticks the book works with
+// Only needed at the edges (feeds, gateways, reports) - everything inside the book stays in ticks
+inline Price ToTicks(double price, double tickSize)
+{
+    return static_cast<Price>(llround(price / tickSize));
+}
+
+inline double FromTicks(Price price, double tickSize)
+{
+    return price * tickSize;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "Constants.h"
+#include "LevelInfo.h"
+#include "Usings.h"
+
+// Fixed size copy of the top of an OrderBook, published after every command for other threads to read
+// (OrderBook::GetTopOfBook, enabled with OrderBookConfig::publishedLevels_)
+struct TopOfBook
+{
+    static constexpr size_t MaxLevels = 16;
+
+    // Bids and asks side by side, best first, so a book publishing n levels only writes the first n rows
+    struct Row
+    {
+        LevelInfo bid_{};
+        LevelInfo ask_{};
+    };
+
+    // Commands published so far: two copies with the same sequence show the same book
+    uint64_t sequence_ = 0;
+    // Resting orders, waiting stops included (OrderBook::Size)
+    uint64_t orderCount_ = 0;
+    Price lastTradePrice_ = Constants::InvalidPrice;
+    uint32_t bidLevelCount_ = 0;
+    uint32_t askLevelCount_ = 0;
+    uint32_t reserved_ = 0;
+    // Only bid_ of the first bidLevelCount_ rows and ask_ of the first askLevelCount_ rows mean anything
+    Row rows_[MaxLevels]{};
+
+    bool HasBid() const { return bidLevelCount_ > 0; }
+    bool HasAsk() const { return askLevelCount_ > 0; }
+    const LevelInfo &GetBid(size_t level) const { return rows_[level].bid_; }
+    const LevelInfo &GetAsk(size_t level) const { return rows_[level].ask_; }
+
+    // Bytes from the start that hold everything the counts cover
+    size_t UsedSize() const { return offsetof(TopOfBook, rows_) + max(bidLevelCount_, askLevelCount_) * sizeof(Row); }
+};
+static_assert(sizeof(TopOfBook) % sizeof(uint64_t) == 0 && offsetof(TopOfBook, rows_) % sizeof(uint64_t) == 0);
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <vector>
 using namespace std;
 
 // Type aliases for common types used in the trading system
-using Price = double;
+// Prices are fixed point: an integer number of ticks (see Tick.h for converting to/from decimal prices)
+// Integer keys compare exactly and can index straight into the price ladder (BookSide)
+using Price = int32_t;
 using Quantity = int;
 using OrderId = int;
-using OrderIds = vector<OrderId>;
\ No newline at end of file
+using OrderIds = vector<OrderId>;
+// Dense index of an instrument inside a ShardedEngine, assigned in the order symbols are configured
+using SymbolId = uint32_t;
+// When a GoodTillTime order leaves the book, whole seconds of system_clock (UTC)
+using ExpiryTime = chrono::sys_seconds;
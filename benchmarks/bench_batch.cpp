@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "../OrderBook.h"
+
+// Opening burst: `batch` orders per call, mostly resting on a handful of prices with the odd crossing order
+// One by one SubmitOrder vs SubmitOrders on the same stream
+
+namespace
+{
+    std::vector<OrderRequest> MakeBurst(int count)
+    {
+        std::vector<OrderRequest> requests;
+        requests.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            const bool crossing = i % 16 == 15;
+            const Side side = i % 2 ? Side::Sell : Side::Buy;
+            const Price price = side == Side::Buy ? (crossing ? 105 : 95 + i % 4) : (crossing ? 95 : 102 + i % 4);
+            requests.push_back(OrderRequest{OrderType::GoodTillCancel, i, side, price, 10});
+        }
+        return requests;
+    }
+
+    constexpr int BurstOrders = 1 << 14;
+}
+
+static void BM_SubmitOrderOneByOne(benchmark::State &state)
+{
+    const auto requests = MakeBurst(BurstOrders);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto orderBook = std::make_unique<OrderBook>(OrderBookConfig{.startPruneThread_ = false});
+        state.ResumeTiming();
+
+        for (const auto &request : requests)
+            orderBook->SubmitOrder(request);
+
+        state.PauseTiming();
+        orderBook.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * BurstOrders);
+}
+BENCHMARK(BM_SubmitOrderOneByOne);
+
+static void BM_SubmitOrdersBatch(benchmark::State &state)
+{
+    const auto requests = MakeBurst(BurstOrders);
+    const auto batch = static_cast<size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto orderBook = std::make_unique<OrderBook>(OrderBookConfig{.startPruneThread_ = false});
+        state.ResumeTiming();
+
+        const std::span<const OrderRequest> all(requests);
+        for (size_t begin = 0; begin < all.size(); begin += batch)
+            orderBook->SubmitOrders(all.subspan(begin, std::min(batch, all.size() - begin)));
+
+        state.PauseTiming();
+        orderBook.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * BurstOrders);
+}
+BENCHMARK(BM_SubmitOrdersBatch)->ArgName("batch")->Arg(16)->Arg(256);
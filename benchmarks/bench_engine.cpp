@@ -0,0 +1,171 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../MatchingEngine.h"
+#include "../ShardedEngine.h"
+
+// Single writer ring engine vs. the book shared between producers behind one mutex
+// Every producer sends `perProducer` orders, alternating buy/sell at one price so the book stays small.
+// Latency is submit -> ack: for the mutex design that includes waiting for the lock,
+// for the engine it is the time until the consumer sees the Accepted report.
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    constexpr int PerProducer = 50000;
+
+    OrderRequest MakeOrder(int producer, int i)
+    {
+        const Side side = i % 2 ? Side::Sell : Side::Buy;
+        return OrderRequest{OrderType::GoodTillCancel, producer * PerProducer + i, side, 100, 1};
+    }
+
+    void ReportLatencies(benchmark::State &state, std::vector<int64_t> &latencies)
+    {
+        if (latencies.empty())
+            return;
+        std::sort(latencies.begin(), latencies.end());
+        state.counters["p50_ns"] = static_cast<double>(latencies[latencies.size() / 2]);
+        state.counters["p99_ns"] = static_cast<double>(latencies[latencies.size() * 99 / 100]);
+        state.counters["max_ns"] = static_cast<double>(latencies.back());
+    }
+}
+
+static void BM_MutexBook(benchmark::State &state)
+{
+    const int producers = static_cast<int>(state.range(0));
+    std::vector<int64_t> latencies(static_cast<size_t>(producers) * PerProducer);
+
+    for (auto _ : state)
+    {
+        OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+        std::mutex bookMutex;
+
+        const auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]
+                                 {
+                for (int i = 0; i < PerProducer; ++i)
+                {
+                    const auto submitted = Clock::now();
+                    {
+                        std::scoped_lock lock{bookMutex};
+                        orderBook.SubmitOrder(MakeOrder(p, i));
+                    }
+                    latencies[p * PerProducer + i] = (Clock::now() - submitted).count();
+                } });
+        }
+        for (auto &thread : threads)
+            thread.join();
+
+        state.SetIterationTime(std::chrono::duration<double>(Clock::now() - start).count());
+    }
+
+    state.SetItemsProcessed(state.iterations() * producers * PerProducer);
+    ReportLatencies(state, latencies);
+}
+BENCHMARK(BM_MutexBook)->ArgName("producers")->Arg(1)->Arg(2)->Arg(4)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+static void BM_RingEngine(benchmark::State &state)
+{
+    const int producers = static_cast<int>(state.range(0));
+    const size_t total = static_cast<size_t>(producers) * PerProducer;
+    std::vector<Clock::time_point> submittedAt(total);
+    std::vector<int64_t> latencies;
+    latencies.reserve(total);
+
+    for (auto _ : state)
+    {
+        latencies.clear();
+        MatchingEngine engine;
+
+        const auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]
+                                 {
+                for (int i = 0; i < PerProducer; ++i)
+                {
+                    submittedAt[p * PerProducer + i] = Clock::now();
+                    engine.Submit(EngineCommand::Add(MakeOrder(p, i)));
+                } });
+        }
+
+        // This thread is the report consumer
+        size_t accepted = 0;
+        while (accepted < total)
+        {
+            engine.PollReports([&](const ExecutionReport &report)
+                               {
+                if (report.type_ != ReportType::Accepted)
+                    return;
+                latencies.push_back((Clock::now() - submittedAt[report.orderId_]).count());
+                ++accepted; });
+        }
+
+        state.SetIterationTime(std::chrono::duration<double>(Clock::now() - start).count());
+        for (auto &thread : threads)
+            thread.join();
+    }
+
+    state.SetItemsProcessed(state.iterations() * total);
+    ReportLatencies(state, latencies);
+}
+BENCHMARK(BM_RingEngine)->ArgName("producers")->Arg(1)->Arg(2)->Arg(4)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+// Many symbols spread over `shards` workers, one producer per worker feeding only that worker's symbols
+// With a core per worker the aggregate rate should grow about linearly with shards
+static void BM_ShardedEngine(benchmark::State &state)
+{
+    const int shards = static_cast<int>(state.range(0));
+    constexpr int Symbols = 64;
+    std::vector<std::string> symbols;
+    for (int s = 0; s < Symbols; ++s)
+        symbols.push_back("SYM" + std::to_string(s));
+    const size_t total = static_cast<size_t>(shards) * PerProducer;
+
+    for (auto _ : state)
+    {
+        ShardedEngine engine(ShardedEngineConfig{.symbols_ = symbols, .shards_ = static_cast<size_t>(shards)});
+
+        const auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (int p = 0; p < shards; ++p)
+        {
+            threads.emplace_back([&, p]
+                                 {
+                // Symbols p, p + shards, ... all live on worker p
+                const int symbolsPerShard = Symbols / shards;
+                for (int i = 0; i < PerProducer; ++i)
+                {
+                    const auto symbol = static_cast<SymbolId>(p + (i % symbolsPerShard) * shards);
+                    engine.Submit(symbol, EngineCommand::Add(MakeOrder(0, i)));
+                } });
+        }
+
+        size_t accepted = 0;
+        while (accepted < total)
+        {
+            engine.PollReports([&](const ExecutionReport &report)
+                               { accepted += report.type_ == ReportType::Accepted; });
+        }
+
+        state.SetIterationTime(std::chrono::duration<double>(Clock::now() - start).count());
+        for (auto &thread : threads)
+            thread.join();
+    }
+
+    state.SetItemsProcessed(state.iterations() * total);
+}
+BENCHMARK(BM_ShardedEngine)->ArgName("shards")->Arg(1)->Arg(2)->Arg(4)->UseManualTime()->Unit(benchmark::kMillisecond);
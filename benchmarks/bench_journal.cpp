@@ -0,0 +1,232 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "../Journal.h"
+#include "../OrderBook.h"
+
+// What the write-ahead journal costs on top of matching
+// Same mixed stream (adds around a mid price, every 4th command a cancel) applied with and without a journal,
+// the journal variants differ in how often they msync. groupCommit 0 = never synced (page cache only).
+
+namespace
+{
+    constexpr int Commands = 1 << 16;
+
+    std::vector<EngineCommand> MakeStream()
+    {
+        std::vector<EngineCommand> commands;
+        commands.reserve(Commands);
+        for (int i = 0; i < Commands; ++i)
+        {
+            if (i % 4 == 3)
+            {
+                commands.push_back(EngineCommand::Cancel(i - 2));
+                continue;
+            }
+            const Side side = i % 2 ? Side::Sell : Side::Buy;
+            const Price price = side == Side::Buy ? 95 + i % 8 : 98 + i % 8;
+            commands.push_back(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, i, side, price, 10}));
+        }
+        return commands;
+    }
+
+    std::string JournalPath()
+    {
+        return (std::filesystem::temp_directory_path() / "orderbook_bench.journal").string();
+    }
+}
+
+static void BM_MatchWithoutJournal(benchmark::State &state)
+{
+    const auto commands = MakeStream();
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto orderBook = std::make_unique<OrderBook>(OrderBookConfig{.startPruneThread_ = false});
+        state.ResumeTiming();
+
+        for (const auto &command : commands)
+            orderBook->SubmitCommand(command);
+
+        state.PauseTiming();
+        orderBook.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * Commands);
+}
+BENCHMARK(BM_MatchWithoutJournal);
+
+// range(0): group commit size, range(1): 1 = msync, 0 = leave it to the kernel
+static void BM_MatchWithJournal(benchmark::State &state)
+{
+    const auto commands = MakeStream();
+    const auto groupCommit = static_cast<size_t>(state.range(0));
+    const bool sync = state.range(1) != 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::filesystem::remove(JournalPath());
+        auto orderBook = std::make_unique<OrderBook>(OrderBookConfig{.startPruneThread_ = false});
+        // Preallocated for the whole stream, growth is not what is measured here
+        auto journal = std::make_unique<Journal>(JournalConfig{JournalPath(), Commands, groupCommit, sync});
+        state.ResumeTiming();
+
+        for (const auto &command : commands)
+        {
+            journal->Append(command);
+            orderBook->SubmitCommand(command);
+        }
+        journal->Commit();
+
+        state.PauseTiming();
+        journal.reset();
+        orderBook.reset();
+        state.ResumeTiming();
+    }
+    std::filesystem::remove(JournalPath());
+    state.SetItemsProcessed(state.iterations() * Commands);
+}
+BENCHMARK(BM_MatchWithJournal)->ArgNames({"groupCommit", "sync"})->Args({0, 0})->Args({4096, 1})->Args({256, 1});
+
+// Recovery speed: replaying a journal into a fresh book
+static void BM_JournalReplay(benchmark::State &state)
+{
+    const auto commands = MakeStream();
+    std::filesystem::remove(JournalPath());
+    {
+        Journal journal(JournalConfig{JournalPath(), Commands, 0, false});
+        for (const auto &command : commands)
+            journal.Append(command);
+    }
+
+    Journal journal(JournalConfig{JournalPath()});
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto orderBook = std::make_unique<OrderBook>(OrderBookConfig{.startPruneThread_ = false});
+        state.ResumeTiming();
+
+        journal.Replay(*orderBook);
+
+        state.PauseTiming();
+        orderBook.reset();
+        state.ResumeTiming();
+    }
+    std::filesystem::remove(JournalPath());
+    state.SetItemsProcessed(state.iterations() * Commands);
+}
+BENCHMARK(BM_JournalReplay);
+
+// Append alone, the per command cost the journal adds to the matching thread
+static void BM_JournalAppend(benchmark::State &state)
+{
+    const auto commands = MakeStream();
+    std::unique_ptr<Journal> journal;
+    size_t next = commands.size();
+    for (auto _ : state)
+    {
+        // Start a fresh preallocated file whenever the stream has been used up
+        if (next == commands.size())
+        {
+            state.PauseTiming();
+            journal.reset();
+            std::filesystem::remove(JournalPath());
+            journal = std::make_unique<Journal>(JournalConfig{JournalPath(), Commands, 0, false});
+            next = 0;
+            state.ResumeTiming();
+        }
+        journal->Append(commands[next++]);
+    }
+    journal.reset();
+    std::filesystem::remove(JournalPath());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_JournalAppend);
+
+// Cold start of a deep book: range(0) resting orders over 2000 price levels per side,
+// rebuilt from a snapshot vs replayed from a journal of the day that built it
+// (the day also had `ChurnPerOrder` orders that were added and cancelled again for every one still resting)
+namespace
+{
+    std::string SnapshotPath()
+    {
+        return (std::filesystem::temp_directory_path() / "orderbook_bench.snapshot").string();
+    }
+
+    OrderRequest DeepBookOrder(int i)
+    {
+        const Side side = i % 2 ? Side::Sell : Side::Buy;
+        const Price offset = (i / 2) % 2000;
+        return OrderRequest{OrderType::GoodTillCancel, i, side, side == Side::Buy ? 10000 - offset : 10001 + offset, 10};
+    }
+
+    constexpr int ChurnPerOrder = 4;
+}
+
+static void BM_SnapshotLoad(benchmark::State &state)
+{
+    const auto orders = static_cast<int>(state.range(0));
+    {
+        OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+        for (int i = 0; i < orders; ++i)
+            orderBook.SubmitOrder(DeepBookOrder(i));
+        orderBook.SaveSnapshot(SnapshotPath());
+    }
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto orderBook = std::make_unique<OrderBook>(OrderBookConfig{.startPruneThread_ = false});
+        state.ResumeTiming();
+
+        orderBook->LoadSnapshot(SnapshotPath());
+
+        state.PauseTiming();
+        orderBook.reset();
+        state.ResumeTiming();
+    }
+    std::filesystem::remove(SnapshotPath());
+    state.SetItemsProcessed(state.iterations() * orders);
+}
+BENCHMARK(BM_SnapshotLoad)->ArgName("orders")->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+static void BM_JournalReplayDay(benchmark::State &state)
+{
+    const auto orders = static_cast<int>(state.range(0));
+    std::filesystem::remove(JournalPath());
+    {
+        Journal journal(JournalConfig{JournalPath(), static_cast<size_t>(orders) * (1 + 2 * ChurnPerOrder), 0, false});
+        for (int i = 0; i < orders; ++i)
+        {
+            journal.Append(EngineCommand::Add(DeepBookOrder(i)));
+            for (int churn = 1; churn <= ChurnPerOrder; ++churn)
+            {
+                OrderRequest transient = DeepBookOrder(i);
+                transient.orderId_ += churn * orders;
+                journal.Append(EngineCommand::Add(transient));
+                journal.Append(EngineCommand::Cancel(transient.orderId_));
+            }
+        }
+    }
+
+    Journal journal(JournalConfig{JournalPath()});
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto orderBook = std::make_unique<OrderBook>(OrderBookConfig{.startPruneThread_ = false});
+        state.ResumeTiming();
+
+        journal.Replay(*orderBook);
+
+        state.PauseTiming();
+        orderBook.reset();
+        state.ResumeTiming();
+    }
+    std::filesystem::remove(JournalPath());
+    state.SetItemsProcessed(state.iterations() * orders);
+}
+BENCHMARK(BM_JournalReplayDay)->ArgName("orders")->Arg(1 << 20)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include <span>
+
+#include "../OrderBook.h"
+
+// Publishing depth after every command on a book `levels` deep per side:
+// polling the full GetOrderBookLevelInfos vs consuming the per command LevelUpdates
+// Each iteration adds one order at the top of the book and cancels it again (two commands).
+// BM_PublishTopOfBook is the same loop with `published` levels per side copied to the TopOfBook seqlock instead.
+
+namespace
+{
+    void FillBook(OrderBook &orderBook, int levels)
+    {
+        OrderId orderId = 0;
+        for (int level = 0; level < levels; ++level)
+        {
+            orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, orderId++, Side::Buy, 10000 - level, 10});
+            orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, orderId++, Side::Sell, 10001 + level, 10});
+        }
+    }
+
+    struct UpdateCounter
+    {
+        size_t updates_ = 0;
+        void OnLevelUpdates(std::span<const LevelUpdate> updates) { updates_ += updates.size(); }
+    };
+
+    constexpr OrderId ProbeId = 1 << 30;
+}
+
+static void BM_PollLevelInfos(benchmark::State &state)
+{
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    FillBook(orderBook, static_cast<int>(state.range(0)));
+
+    for (auto _ : state)
+    {
+        orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, ProbeId, Side::Buy, 10000, 1});
+        benchmark::DoNotOptimize(orderBook.GetOrderBookLevelInfos());
+        orderBook.CancelOrder(ProbeId);
+        benchmark::DoNotOptimize(orderBook.GetOrderBookLevelInfos());
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_PollLevelInfos)->ArgName("levels")->Arg(10)->Arg(1000)->Arg(100000);
+
+static void BM_LevelUpdates(benchmark::State &state)
+{
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    FillBook(orderBook, static_cast<int>(state.range(0)));
+    UpdateCounter counter;
+    orderBook.SetExecutionListener(MakeExecutionListener(counter));
+
+    for (auto _ : state)
+    {
+        orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, ProbeId, Side::Buy, 10000, 1});
+        orderBook.CancelOrder(ProbeId);
+    }
+    benchmark::DoNotOptimize(counter.updates_);
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_LevelUpdates)->ArgName("levels")->Arg(10)->Arg(1000)->Arg(100000);
+
+static void BM_PublishTopOfBook(benchmark::State &state)
+{
+    OrderBook orderBook(OrderBookConfig{.publishedLevels_ = static_cast<size_t>(state.range(0)), .startPruneThread_ = false});
+    FillBook(orderBook, 1000);
+
+    for (auto _ : state)
+    {
+        orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, ProbeId, Side::Buy, 10000, 1});
+        orderBook.CancelOrder(ProbeId);
+    }
+    benchmark::DoNotOptimize(orderBook.GetTopOfBook());
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_PublishTopOfBook)->ArgName("published")->Arg(0)->Arg(1)->Arg(5)->Arg(16);
@@ -0,0 +1,324 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../OrderBook.h"
+
+// Core book operations against a resting book `levels` deep per side with `perLevel` orders in each level
+// `ladder` 1 puts the whole book inside the price ladder, 0 is the map only book
+// Bids rest at Mid - 1, Mid - 2 ... and asks at Mid, Mid + 1 ..., every order for OrderQuantity
+// Operations that change the book size are timed in rounds of RoundOrders and undone with the timer paused
+
+namespace
+{
+    constexpr Price Mid = 1 << 20;
+    constexpr Quantity OrderQuantity = 10;
+    constexpr int RoundOrders = 1024;
+    // Ids handed out during a run, above every resting order's id
+    constexpr OrderId FirstFreeId = 1 << 28;
+
+    struct Depth
+    {
+        int levels_;
+        int perLevel_;
+        bool ladder_;
+    };
+
+    Depth GetDepth(const benchmark::State &state)
+    {
+        return Depth{static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), state.range(2) != 0};
+    }
+
+    Price BidPrice(int level) { return Mid - 1 - level; }
+    Price AskPrice(int level) { return Mid + level; }
+
+    // Resting order ids: bids first, then asks, level by level in queue order
+    OrderId RestingId(const Depth &depth, Side side, int level, int position)
+    {
+        const OrderId sideOffset = side == Side::Buy ? 0 : depth.levels_ * depth.perLevel_;
+        return sideOffset + level * depth.perLevel_ + position;
+    }
+
+    void FillLevel(OrderBook &orderBook, const Depth &depth, Side side, int level)
+    {
+        const Price price = side == Side::Buy ? BidPrice(level) : AskPrice(level);
+        for (int position = 0; position < depth.perLevel_; ++position)
+            orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, RestingId(depth, side, level, position), side, price, OrderQuantity});
+    }
+
+    std::unique_ptr<OrderBook> MakeBook(const Depth &depth)
+    {
+        OrderBookConfig config{.startPruneThread_ = false};
+        config.orderPoolReserve_ = 2 * static_cast<size_t>(depth.levels_ * depth.perLevel_) + RoundOrders;
+        if (depth.ladder_)
+        {
+            config.ladderMinPrice_ = BidPrice(depth.levels_) - 1;
+            config.ladderLevels_ = 2 * static_cast<size_t>(depth.levels_) + 2;
+        }
+
+        auto orderBook = std::make_unique<OrderBook>(config);
+        for (int level = 0; level < depth.levels_; ++level)
+        {
+            FillLevel(*orderBook, depth, Side::Buy, level);
+            FillLevel(*orderBook, depth, Side::Sell, level);
+        }
+        return orderBook;
+    }
+
+    // Same total order count at three shapes, each in both storages
+    void DepthArgs(benchmark::internal::Benchmark *bench)
+    {
+        bench->ArgNames({"levels", "perLevel", "ladder"});
+        for (int ladder : {0, 1})
+        {
+            bench->Args({16, 256, ladder});
+            bench->Args({1024, 4, ladder});
+            bench->Args({4096, 1, ladder});
+        }
+    }
+
+    // How far the aggressive order reaches, on a book deep enough for all of them
+    // plus one sweep through a single deep level (256 orders), where walking the queue itself dominates
+    void SweepArgs(benchmark::internal::Benchmark *bench)
+    {
+        bench->ArgNames({"levels", "perLevel", "ladder", "sweep"});
+        for (int ladder : {0, 1})
+        {
+            for (int sweep : {1, 8, 64})
+                bench->Args({1024, 4, ladder, sweep});
+            bench->Args({16, 256, ladder, 1});
+        }
+    }
+}
+
+// New orders joining the back of existing levels, the common case for a passive order
+static void BM_AddPassive(benchmark::State &state)
+{
+    const Depth depth = GetDepth(state);
+    auto orderBook = MakeBook(depth);
+    std::mt19937 random(1);
+
+    std::vector<OrderRequest> requests(RoundOrders);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        for (int i = 0; i < RoundOrders; ++i)
+        {
+            const Side side = random() % 2 ? Side::Buy : Side::Sell;
+            const int level = static_cast<int>(random() % depth.levels_);
+            requests[i] = OrderRequest{OrderType::GoodTillCancel, FirstFreeId + i, side,
+                                       side == Side::Buy ? BidPrice(level) : AskPrice(level), OrderQuantity};
+        }
+        state.ResumeTiming();
+
+        for (const auto &request : requests)
+            orderBook->SubmitOrder(request);
+
+        state.PauseTiming();
+        for (const auto &request : requests)
+            orderBook->CancelOrder(request.orderId_);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * RoundOrders);
+}
+BENCHMARK(BM_AddPassive)->Apply(DepthArgs);
+
+// One buy that takes out the best `sweep` ask levels completely, as a limit order that could rest
+// or as one of the types that never do (FillAndKill, Market)
+static void BM_AggressiveSweep(benchmark::State &state, OrderType orderType)
+{
+    const Depth depth = GetDepth(state);
+    const int sweep = static_cast<int>(state.range(3));
+    auto orderBook = MakeBook(depth);
+    const Quantity quantity = sweep * depth.perLevel_ * OrderQuantity;
+
+    OrderId orderId = FirstFreeId;
+    for (auto _ : state)
+    {
+        orderBook->SubmitOrder(OrderRequest{orderType, orderId++, Side::Buy, AskPrice(sweep - 1), quantity});
+
+        state.PauseTiming();
+        for (int level = 0; level < sweep; ++level)
+            FillLevel(*orderBook, depth, Side::Sell, level);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * sweep * depth.perLevel_);
+    state.counters["levels/s"] = benchmark::Counter(static_cast<double>(state.iterations() * sweep), benchmark::Counter::kIsRate);
+}
+BENCHMARK_CAPTURE(BM_AggressiveSweep, limit, OrderType::GoodTillCancel)->Apply(SweepArgs);
+BENCHMARK_CAPTURE(BM_AggressiveSweep, fak, OrderType::FillAndKill)->Apply(SweepArgs);
+BENCHMARK_CAPTURE(BM_AggressiveSweep, market, OrderType::Market)->Apply(SweepArgs);
+
+// One buy taking out a whole level of `perLevel` orders that arrived shuffled in with the orders of 63 other
+// levels, so they sit at random places in the pool, with the caches flushed first: following one order to the
+// next is a miss each time, the case ORDERBOOK_SOA_LEVELS builds are meant for
+static void BM_SweepColdLevel(benchmark::State &state)
+{
+    constexpr int Levels = 64;
+    const int perLevel = static_cast<int>(state.range(0));
+    OrderBookConfig config{.startPruneThread_ = false};
+    config.ladderMinPrice_ = AskPrice(0);
+    config.ladderLevels_ = Levels;
+    config.orderPoolReserve_ = static_cast<size_t>(Levels * perLevel) + 1;
+    auto orderBook = std::make_unique<OrderBook>(config);
+
+    std::vector<int> arrivals;
+    for (int level = 0; level < Levels; ++level)
+        arrivals.insert(arrivals.end(), perLevel, level);
+    std::shuffle(arrivals.begin(), arrivals.end(), std::mt19937(1));
+    OrderId orderId = 0;
+    for (const int level : arrivals)
+        orderBook->SubmitOrder(OrderRequest{OrderType::GoodTillCancel, orderId++, Side::Sell, AskPrice(level), OrderQuantity});
+
+    std::vector<char> evict(32 << 20);
+    orderId = FirstFreeId;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        for (size_t i = 0; i < evict.size(); i += 64)
+            ++evict[i];
+        benchmark::ClobberMemory();
+        state.ResumeTiming();
+
+        orderBook->SubmitOrder(OrderRequest{OrderType::GoodTillCancel, orderId++, Side::Buy, AskPrice(0), perLevel * OrderQuantity});
+
+        // The refill takes back the slots the sweep just freed, so the level stays scattered
+        state.PauseTiming();
+        for (int position = 0; position < perLevel; ++position)
+            orderBook->SubmitOrder(OrderRequest{OrderType::GoodTillCancel, orderId++, Side::Sell, AskPrice(0), OrderQuantity});
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * perLevel);
+}
+BENCHMARK(BM_SweepColdLevel)->ArgName("perLevel")->Arg(256)->Arg(4096);
+
+// Cancels of resting orders picked at random, so from anywhere in their queues
+static void BM_CancelRandom(benchmark::State &state)
+{
+    const Depth depth = GetDepth(state);
+    auto orderBook = MakeBook(depth);
+    std::mt19937 random(2);
+
+    const int restingOrders = 2 * depth.levels_ * depth.perLevel_;
+    std::vector<OrderId> orderIds(restingOrders);
+    for (OrderId orderId = 0; orderId < restingOrders; ++orderId)
+        orderIds[orderId] = orderId;
+
+    const int perSide = depth.levels_ * depth.perLevel_;
+    std::vector<OrderId> round(RoundOrders);
+    std::vector<OrderRequest> readd(RoundOrders);
+    size_t next = orderIds.size();
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        for (auto &orderId : round)
+        {
+            if (next == orderIds.size())
+            {
+                std::shuffle(orderIds.begin(), orderIds.end(), random);
+                next = 0;
+            }
+            orderId = orderIds[next++];
+        }
+        // Put them back where they were price wise (the back of the queue) once they are cancelled
+        for (int i = 0; i < RoundOrders; ++i)
+        {
+            const OrderId orderId = round[i];
+            const Side side = orderId < perSide ? Side::Buy : Side::Sell;
+            const int level = (orderId % perSide) / depth.perLevel_;
+            readd[i] = OrderRequest{OrderType::GoodTillCancel, orderId, side,
+                                    side == Side::Buy ? BidPrice(level) : AskPrice(level), OrderQuantity};
+        }
+        state.ResumeTiming();
+
+        for (OrderId orderId : round)
+            orderBook->CancelOrder(orderId);
+
+        state.PauseTiming();
+        // A round can pick an id twice, the repeat cancel is a miss and SubmitOrder rejects the duplicate
+        for (const auto &request : readd)
+            orderBook->SubmitOrder(request);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * RoundOrders);
+}
+BENCHMARK(BM_CancelRandom)->Apply(DepthArgs);
+
+// Resting orders moved to another passive level (cancel + add, with the Trades returning API)
+static void BM_ModifyOrder(benchmark::State &state)
+{
+    const Depth depth = GetDepth(state);
+    auto orderBook = MakeBook(depth);
+    std::mt19937 random(3);
+    const int perSide = depth.levels_ * depth.perLevel_;
+
+    for (auto _ : state)
+    {
+        const auto orderId = static_cast<OrderId>(random() % (2 * perSide));
+        const Side side = orderId < perSide ? Side::Buy : Side::Sell;
+        const int level = static_cast<int>(random() % depth.levels_);
+        benchmark::DoNotOptimize(orderBook->ModifyOrder(
+            OrderModify(orderId, side, side == Side::Buy ? BidPrice(level) : AskPrice(level), OrderQuantity)));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ModifyOrder)->Apply(DepthArgs);
+
+// Same price size-down amend, shrinks in place: no lookup beyond the id, no matching, no allocation
+// Every resting order loses 1 per pass until they're down to 1, then the book is rebuilt with the timer paused
+static void BM_ReduceOrder(benchmark::State &state)
+{
+    const Depth depth = GetDepth(state);
+    auto orderBook = MakeBook(depth);
+    const int perSide = depth.levels_ * depth.perLevel_;
+    OrderId orderId = 0;
+    Quantity quantity = OrderQuantity - 1;
+
+    for (auto _ : state)
+    {
+        const Side side = orderId < perSide ? Side::Buy : Side::Sell;
+        const int level = static_cast<int>(orderId % perSide) / depth.perLevel_;
+        orderBook->SubmitModify(OrderModify(orderId, side, side == Side::Buy ? BidPrice(level) : AskPrice(level), quantity));
+        if (++orderId < 2 * perSide)
+            continue;
+        orderId = 0;
+        if (--quantity == 0)
+        {
+            state.PauseTiming();
+            orderBook = MakeBook(depth);
+            quantity = OrderQuantity - 1;
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ReduceOrder)->Apply(DepthArgs);
+
+// Full depth snapshot, O(levels)
+static void BM_GetOrderBookLevelInfos(benchmark::State &state)
+{
+    const Depth depth = GetDepth(state);
+    auto orderBook = MakeBook(depth);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(orderBook->GetOrderBookLevelInfos());
+    state.SetItemsProcessed(state.iterations() * 2 * depth.levels_);
+}
+BENCHMARK(BM_GetOrderBookLevelInfos)->Apply(DepthArgs);
+
+// FillOrKill that walks `sweep` levels and comes up one short, the admission check alone (the book never changes)
+static void BM_FillOrKillAdmission(benchmark::State &state)
+{
+    const Depth depth = GetDepth(state);
+    const int sweep = static_cast<int>(state.range(3));
+    auto orderBook = MakeBook(depth);
+    const Quantity quantity = sweep * depth.perLevel_ * OrderQuantity + 1;
+
+    for (auto _ : state)
+        orderBook->SubmitOrder(OrderRequest{OrderType::FillOrKill, FirstFreeId, Side::Buy, AskPrice(sweep - 1), quantity});
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FillOrKillAdmission)->Apply(SweepArgs);
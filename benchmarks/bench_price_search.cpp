@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <vector>
+
+#include "../LevelBitmap.h"
+#include "../OrderList.h"
+
+// Scenario: the best level empties and the next populated one has to be found
+// Each round fills `levels` levels spaced `spacing` ticks apart, then pops the best one until the side is empty.
+// spacing 1 is a dense book, larger spacings are thin books where a linear ladder scan hurts.
+
+static void PriceSearchArgs(benchmark::internal::Benchmark *bench)
+{
+    bench->ArgNames({"levels", "spacing"});
+    for (int spacing : {1, 16, 256})
+        bench->Args({1024, spacing});
+}
+
+static void BM_MapNextBest(benchmark::State &state)
+{
+    const auto levels = state.range(0);
+    const auto spacing = state.range(1);
+    std::map<Price, OrderList, std::less<Price>> asks;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        for (Price level = 0; level < levels; ++level)
+            asks[level * spacing];
+        state.ResumeTiming();
+
+        while (!asks.empty())
+        {
+            asks.erase(asks.begin());
+            if (!asks.empty())
+                benchmark::DoNotOptimize(asks.begin()->first);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * levels);
+}
+BENCHMARK(BM_MapNextBest)->Apply(PriceSearchArgs);
+
+static void BM_BitmapNextBest(benchmark::State &state)
+{
+    const auto levels = state.range(0);
+    const auto spacing = state.range(1);
+    LevelBitmap occupied(levels * spacing);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        for (size_t level = 0; level < static_cast<size_t>(levels); ++level)
+            occupied.Set(level * spacing);
+        state.ResumeTiming();
+
+        for (size_t best = occupied.First(); best != LevelBitmap::npos;)
+        {
+            occupied.Clear(best);
+            best = occupied.FindNext(best + 1);
+            benchmark::DoNotOptimize(best);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * levels);
+}
+BENCHMARK(BM_BitmapNextBest)->Apply(PriceSearchArgs);
+
+// What the ladder would do without the bitmap
+static void BM_LinearScanNextBest(benchmark::State &state)
+{
+    const auto levels = state.range(0);
+    const auto spacing = state.range(1);
+    std::vector<bool> occupied(levels * spacing);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        for (size_t level = 0; level < static_cast<size_t>(levels); ++level)
+            occupied[level * spacing] = true;
+        state.ResumeTiming();
+
+        size_t best = 0;
+        while (best < occupied.size())
+        {
+            occupied[best] = false;
+            while (++best < occupied.size() && !occupied[best])
+                ;
+            benchmark::DoNotOptimize(best);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * levels);
+}
+BENCHMARK(BM_LinearScanNextBest)->Apply(PriceSearchArgs);
@@ -0,0 +1,82 @@
+// orderbook_gateway: serves one OrderBook over TCP (see Gateway.h) until SIGINT / SIGTERM
+//   orderbook_gateway [--address ADDR] [--port PORT] [--ladder MIN_PRICE LEVELS] [--reserve ORDERS] [--cpu CPU]
+#include <csignal>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+#include "Gateway.h"
+
+using namespace std;
+
+namespace
+{
+    Gateway *running = nullptr;
+
+    void StopOnSignal(int)
+    {
+        if (running)
+            running->Stop();
+    }
+
+    int Usage()
+    {
+        cerr << "usage: orderbook_gateway [--address ADDR] [--port PORT] [--ladder MIN_PRICE LEVELS] [--reserve ORDERS] [--cpu CPU]\n";
+        return 2;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    GatewayConfig config;
+    config.port_ = 9100;
+    for (int i = 1; i < argc; ++i)
+    {
+        const string_view option = argv[i];
+        if (option == "--address" && i + 1 < argc)
+            config.address_ = argv[++i];
+        else if (option == "--port" && i + 1 < argc)
+            config.port_ = static_cast<uint16_t>(atoi(argv[++i]));
+        else if (option == "--ladder" && i + 2 < argc)
+        {
+            config.book_.ladderMinPrice_ = static_cast<Price>(atol(argv[++i]));
+            config.book_.ladderLevels_ = static_cast<size_t>(atoll(argv[++i]));
+        }
+        else if (option == "--reserve" && i + 1 < argc)
+            config.book_.orderPoolReserve_ = static_cast<size_t>(atoll(argv[++i]));
+        else if (option == "--cpu" && i + 1 < argc)
+            config.cpu_ = atoi(argv[++i]);
+        else
+            return Usage();
+    }
+
+    try
+    {
+        Gateway gateway(config);
+        running = &gateway;
+        signal(SIGINT, StopOnSignal);
+        signal(SIGTERM, StopOnSignal);
+        cout << "listening on " << config.address_ << ':' << gateway.Port() << endl;
+
+        gateway.Run();
+        running = nullptr;
+
+        const auto &stats = gateway.GetStats();
+        cout << "connections     " << stats.connections_ << '\n'
+             << "requests        " << stats.requests_ << '\n'
+             << "reports         " << stats.reports_ << '\n'
+             << "reads / writes  " << stats.reads_ << " / " << stats.writes_ << '\n'
+             << fixed << setprecision(1)
+             << "requests/read   " << (stats.reads_ ? static_cast<double>(stats.requests_) / static_cast<double>(stats.reads_) : 0.0) << '\n'
+             << "protocol errors " << stats.protocolErrors_ << '\n'
+             << "resting orders  " << gateway.GetOrderBook().Size() << '\n';
+    }
+    catch (const exception &error)
+    {
+        cerr << "orderbook_gateway: " << error.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+// orderbook_loadgen: sends a random order flow to an orderbook_gateway and reports the round trip latency
+//   orderbook_loadgen [--address ADDR] [--port PORT] [--requests N] [--window N] [--first-id ID] [--seed S]
+// --window 1 (the default) measures one request at a time, larger windows keep that many in flight
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+#include "LoadGenerator.h"
+
+using namespace std;
+
+namespace
+{
+    int Usage()
+    {
+        cerr << "usage: orderbook_loadgen [--address ADDR] [--port PORT] [--requests N] [--window N] [--first-id ID] [--seed S]\n";
+        return 2;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    LoadGeneratorConfig config;
+    config.port_ = 9100;
+    for (int i = 1; i < argc; ++i)
+    {
+        const string_view option = argv[i];
+        if (option == "--address" && i + 1 < argc)
+            config.address_ = argv[++i];
+        else if (option == "--port" && i + 1 < argc)
+            config.port_ = static_cast<uint16_t>(atoi(argv[++i]));
+        else if (option == "--requests" && i + 1 < argc)
+            config.requests_ = static_cast<uint64_t>(atoll(argv[++i]));
+        else if (option == "--window" && i + 1 < argc)
+            config.window_ = static_cast<size_t>(atoll(argv[++i]));
+        else if (option == "--first-id" && i + 1 < argc)
+            config.firstOrderId_ = static_cast<OrderId>(atol(argv[++i]));
+        else if (option == "--seed" && i + 1 < argc)
+            config.seed_ = static_cast<uint32_t>(atol(argv[++i]));
+        else
+            return Usage();
+    }
+
+    try
+    {
+        const LoadGeneratorResult result = RunLoadGenerator(config);
+        const double seconds = static_cast<double>(result.elapsed_.count()) / 1e9;
+        const auto &latency = result.roundTrip_;
+
+        cout << "requests        " << result.requests_ << '\n'
+             << "reports         " << result.reports_ << '\n'
+             << "trades          " << result.trades_ << '\n'
+             << "rejects         " << result.rejects_ << '\n'
+             << fixed << setprecision(3)
+             << "elapsed         " << seconds << " s\n"
+             << "throughput      " << (seconds > 0 ? static_cast<double>(result.requests_) / seconds : 0.0) << " requests/s\n"
+             << "round trip ns   mean " << latency.Mean() << "  p50 " << latency.Percentile(0.5) << "  p90 " << latency.Percentile(0.9)
+             << "  p99 " << latency.Percentile(0.99) << "  p99.9 " << latency.Percentile(0.999) << "  max " << latency.Max() << '\n';
+    }
+    catch (const exception &error)
+    {
+        cerr << "orderbook_loadgen: " << error.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+// orderbook_replay: streams a recorded journal or CSV file through an OrderBook and reports how it went
+//   orderbook_replay <file> [--speed X] [--ladder MIN_PRICE LEVELS] [--reserve ORDERS]
+// --speed paces a CSV recording at X times its recorded rate, without it the file is replayed flat out
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+#include "Replay.h"
+
+using namespace std;
+
+namespace
+{
+    int Usage()
+    {
+        cerr << "usage: orderbook_replay <file> [--speed X] [--ladder MIN_PRICE LEVELS] [--reserve ORDERS]\n";
+        return 2;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+        return Usage();
+
+    ReplayConfig config;
+    config.path_ = argv[1];
+    for (int i = 2; i < argc; ++i)
+    {
+        const string_view option = argv[i];
+        if (option == "--speed" && i + 1 < argc)
+            config.speed_ = atof(argv[++i]);
+        else if (option == "--ladder" && i + 2 < argc)
+        {
+            config.book_.ladderMinPrice_ = static_cast<Price>(atol(argv[++i]));
+            config.book_.ladderLevels_ = static_cast<size_t>(atoll(argv[++i]));
+        }
+        else if (option == "--reserve" && i + 1 < argc)
+            config.book_.orderPoolReserve_ = static_cast<size_t>(atoll(argv[++i]));
+        else
+            return Usage();
+    }
+
+    try
+    {
+        const ReplayResult result = RunReplay(config);
+        const double seconds = static_cast<double>(result.elapsed_.count()) / 1e9;
+        const auto &latency = result.latency_;
+
+        cout << "commands        " << result.commands_ << '\n'
+             << "trades          " << result.trades_ << '\n'
+             << "rejects         " << result.rejects_ << '\n'
+             << "cancels         " << result.cancels_ << '\n'
+             << fixed << setprecision(3)
+             << "elapsed         " << seconds << " s\n"
+             << "throughput      " << (seconds > 0 ? static_cast<double>(result.commands_) / seconds : 0.0) << " commands/s\n"
+             << "latency ns      mean " << latency.Mean() << "  p50 " << latency.Percentile(0.5) << "  p90 " << latency.Percentile(0.9)
+             << "  p99 " << latency.Percentile(0.99) << "  p99.9 " << latency.Percentile(0.999) << "  max " << latency.Max() << '\n'
+             << "resting orders  " << result.restingOrders_ << '\n'
+             << "book checksum   " << hex << setw(16) << setfill('0') << result.bookChecksum_ << '\n';
+    }
+    catch (const exception &error)
+    {
+        cerr << "orderbook_replay: " << error.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
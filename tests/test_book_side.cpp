@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "../BookSide.h"
+#include "../OrderBook.h"
+#include "../OrderPool.h"
+#include "../Tick.h"
+
+class BookSideTest : public ::testing::Test {
+protected:
+    Order *MakeOrder(OrderId orderId, Side side, Price price) {
+        return pool.Acquire(OrderType::GoodTillCancel, orderId, side, price, 10);
+    }
+
+    OrderPool pool;
+};
+
+TEST_F(BookSideTest, LadderTracksBestBid) {
+    BookSide<greater<Price>> bids;
+    bids.ConfigureLadder(100, 50);
+
+    bids[110].push_back(MakeOrder(1, Side::Buy, 110));
+    bids[120].push_back(MakeOrder(2, Side::Buy, 120));
+    bids[105].push_back(MakeOrder(3, Side::Buy, 105));
+    EXPECT_EQ(bids.BestPrice(), 120);
+    EXPECT_EQ(bids.size(), 3);
+
+    bids.at(120).pop_front();
+    bids.erase(120);
+    EXPECT_EQ(bids.BestPrice(), 110);
+}
+
+TEST_F(BookSideTest, OverflowOutsideBand) {
+    BookSide<less<Price>> asks;
+    asks.ConfigureLadder(100, 10);
+
+    asks[105].push_back(MakeOrder(1, Side::Sell, 105));
+    asks[95].push_back(MakeOrder(2, Side::Sell, 95));   // Below the band
+    asks[200].push_back(MakeOrder(3, Side::Sell, 200)); // Above the band
+    EXPECT_EQ(asks.BestPrice(), 95);
+
+    std::vector<Price> prices;
+    asks.ForEachLevel([&](Price price, const PriceLevel &) { prices.push_back(price); });
+    EXPECT_EQ(prices, (std::vector<Price>{95, 105, 200}));
+
+    asks.at(95).pop_front();
+    asks.erase(95);
+    EXPECT_EQ(asks.BestPrice(), 105);
+    EXPECT_EQ(asks.Find(95), nullptr);
+    EXPECT_NE(asks.Find(200), nullptr);
+}
+
+TEST_F(BookSideTest, LadderBookMatchesLikeMapBook) {
+    OrderBook orderBook(OrderBookConfig{.ladderMinPrice_ = 90, .ladderLevels_ = 20});
+
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 101, 5});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 102, 5});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 3, Side::Sell, 150, 5}); // Outside the band
+    auto trades = orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 4, Side::Buy, 200, 12});
+
+    ASSERT_EQ(trades.size(), 3);
+    EXPECT_EQ(trades[0].GetAskTrade().price_, 101);
+    EXPECT_EQ(trades[1].GetAskTrade().price_, 102);
+    EXPECT_EQ(trades[2].GetAskTrade().price_, 150);
+    EXPECT_EQ(orderBook.Size(), 1);
+
+    auto levels = orderBook.GetOrderBookLevelInfos();
+    ASSERT_EQ(levels.GetAsks().size(), 1);
+    EXPECT_EQ(levels.GetAsks()[0].quantity_, 3);
+    EXPECT_TRUE(levels.GetBids().empty());
+}
+
+TEST(TickTest, RoundTrip) {
+    EXPECT_EQ(ToTicks(100.25, 0.05), 2005);
+    EXPECT_DOUBLE_EQ(FromTicks(2005, 0.05), 100.25);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "../BookStats.h"
+#include "../OrderBook.h"
+
+namespace {
+    // Stats are process wide, so tests look at what their own commands added
+    std::array<uint64_t, BookOperationCount> LatencyCounts() {
+        const BookStats stats = GetBookStats();
+        std::array<uint64_t, BookOperationCount> counts{};
+        for (size_t operation = 0; operation < BookOperationCount; ++operation)
+            counts[operation] = stats.latency_[operation].Count();
+        return counts;
+    }
+
+    uint64_t Added(const std::array<uint64_t, BookOperationCount> &before, BookOperation operation) {
+        return LatencyCounts()[static_cast<size_t>(operation)] - before[static_cast<size_t>(operation)];
+    }
+}
+
+TEST(BookStatsTest, SharedHistogramMergesIntoPlain) {
+    SharedLatencyHistogram shared;
+    for (uint64_t value : {5, 100, 1000})
+        shared.Record(value);
+
+    LatencyHistogram plain;
+    plain.Record(1);
+    plain.Merge(shared);
+    EXPECT_EQ(plain.Count(), 4u);
+    EXPECT_EQ(plain.Min(), 1u);
+    EXPECT_EQ(plain.Max(), 1000u);
+    EXPECT_EQ(plain.Percentile(0.5), 5u);
+}
+
+TEST(BookStatsTest, NothingRecordedWhenCompiledOut) {
+    if (BookStatsEnabled)
+        GTEST_SKIP() << "built with ORDERBOOK_LATENCY_STATS";
+
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 5});
+    const BookStats stats = GetBookStats();
+    EXPECT_EQ(stats.Latency(BookOperation::AddOrder).Count(), 0u);
+    EXPECT_EQ(stats.levelsCrossed_.Count(), 0u);
+    EXPECT_EQ(stats.allocations_, 0u);
+}
+
+TEST(BookStatsTest, OnlyOutermostCallsAreTimed) {
+    if (!BookStatsEnabled)
+        GTEST_SKIP() << "built without ORDERBOOK_LATENCY_STATS";
+
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    const auto before = LatencyCounts();
+    const uint64_t matchesBefore = GetBookStats().levelsCrossed_.Count();
+
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 101, 5});
+    // Crosses both levels, one match pass
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 3, Side::Buy, 101, 10});
+    // Cancel + add inside, still one modify
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 4, Side::Buy, 90, 5});
+    orderBook.SubmitModify(OrderModify(4, Side::Buy, 91, 5));
+    orderBook.CancelOrder(4);
+
+    EXPECT_EQ(Added(before, BookOperation::AddOrder), 4u);
+    EXPECT_EQ(Added(before, BookOperation::ModifyOrder), 1u);
+    EXPECT_EQ(Added(before, BookOperation::CancelOrder), 1u);
+    EXPECT_EQ(Added(before, BookOperation::MatchOrders), 1u);
+    const BookStats stats = GetBookStats();
+    EXPECT_EQ(stats.levelsCrossed_.Count(), matchesBefore + 1);
+    EXPECT_GE(stats.levelsCrossed_.Max(), 2u);
+    EXPECT_GT(stats.allocations_, 0u);
+}
+
+TEST(BookStatsTest, ExitedThreadsAreKept) {
+    if (!BookStatsEnabled)
+        GTEST_SKIP() << "built without ORDERBOOK_LATENCY_STATS";
+
+    const auto before = LatencyCounts();
+    std::thread([] {
+        OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+        for (OrderId orderId = 0; orderId < 100; ++orderId)
+            orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, orderId, Side::Buy, 100, 1});
+    }).join();
+    EXPECT_EQ(Added(before, BookOperation::AddOrder), 100u);
+}
@@ -0,0 +1,373 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+#include "../OrderBook.h"
+
+// Records every event as a short string so ordering can be checked too
+struct RecordingSink {
+    std::vector<std::string> events;
+
+    void OnAccepted(OrderId orderId) { events.push_back("ack " + std::to_string(orderId)); }
+    void OnRejected(OrderId orderId, RejectReason) { events.push_back("reject " + std::to_string(orderId)); }
+    void OnTrade(const Trade &trade) {
+        events.push_back("trade " + std::to_string(trade.GetBidTrade().orderId_) + "/" +
+                         std::to_string(trade.GetAskTrade().orderId_) + " " +
+                         std::to_string(trade.GetBidTrade().quantity_));
+    }
+    void OnCancelled(OrderId orderId, Quantity remaining) {
+        events.push_back("cancel " + std::to_string(orderId) + " " + std::to_string(remaining));
+    }
+    void OnReduced(OrderId orderId, Quantity remaining) {
+        events.push_back("reduce " + std::to_string(orderId) + " " + std::to_string(remaining));
+    }
+};
+
+TEST(ExecutionListenerTest, AckComesBeforeFills) {
+    OrderBook orderBook;
+    RecordingSink sink;
+    orderBook.SetExecutionListener(MakeExecutionListener(sink));
+
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 8});
+    orderBook.CancelOrder(2);
+
+    EXPECT_EQ(sink.events, (std::vector<std::string>{"ack 1", "ack 2", "trade 2/1 5", "cancel 2 3"}));
+}
+
+TEST(ExecutionListenerTest, ModifyReportsReduceOrReplace) {
+    OrderBook orderBook;
+    RecordingSink sink;
+    orderBook.SetExecutionListener(MakeExecutionListener(sink));
+
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 8});
+    orderBook.SubmitModify(OrderModify(1, Side::Buy, 100, 3));
+    orderBook.SubmitModify(OrderModify(1, Side::Buy, 100, 3));
+    orderBook.SubmitModify(OrderModify(1, Side::Buy, 101, 3));
+
+    EXPECT_EQ(sink.events, (std::vector<std::string>{"ack 1", "reduce 1 3", "reduce 1 3", "cancel 1 3", "ack 1"}));
+}
+
+TEST(ExecutionListenerTest, RejectsAndFillAndKillRemainder) {
+    OrderBook orderBook;
+    RecordingSink sink;
+    orderBook.SetExecutionListener(MakeExecutionListener(sink));
+
+    orderBook.SubmitOrder(OrderRequest{OrderType::FillAndKill, 1, Side::Buy, 100, 5});   // Nothing to hit
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 100, 3});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 100, 3}); // Duplicate id
+    orderBook.SubmitOrder(OrderRequest{OrderType::FillAndKill, 3, Side::Buy, 100, 5});
+
+    EXPECT_EQ(sink.events, (std::vector<std::string>{"reject 1", "ack 2", "reject 2", "ack 3", "trade 3/2 3", "cancel 3 2"}));
+    EXPECT_EQ(orderBook.Size(), 0);
+}
+
+// Sinks only need the callbacks they care about
+struct TradeCounter {
+    int trades = 0;
+    void OnTrade(const Trade &) { ++trades; }
+};
+
+TEST(ExecutionListenerTest, PartialSinkAndTradesAdapter) {
+    OrderBook orderBook;
+    TradeCounter counter;
+    orderBook.SetExecutionListener(MakeExecutionListener(counter));
+
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5});
+    auto trades = orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 5});
+
+    EXPECT_EQ(trades.size(), 1); // The vector adapter still works alongside the listener
+    EXPECT_EQ(counter.trades, 1);
+}
+
+// A burst must produce exactly what the same orders produce one by one
+TEST(ExecutionListenerTest, BatchMatchesSequential) {
+    std::mt19937 random(42);
+    const OrderType types[] = {OrderType::GoodTillCancel, OrderType::GoodTillCancel, OrderType::GoodForDay,
+                               OrderType::FillAndKill, OrderType::FillOrKill, OrderType::Market};
+    std::vector<OrderRequest> requests;
+    for (OrderId orderId = 0; orderId < 2000; ++orderId) {
+        const Side side = random() % 2 ? Side::Buy : Side::Sell;
+        // Repeat an id now and then to get duplicate rejects too
+        const OrderId id = random() % 50 == 0 ? orderId / 2 : orderId;
+        requests.push_back(OrderRequest{types[random() % 6], id, side, static_cast<Price>(95 + random() % 10),
+                                        static_cast<Quantity>(1 + random() % 20)});
+    }
+
+    OrderBook sequentialBook, batchBook;
+    RecordingSink sequential, batch;
+    sequentialBook.SetExecutionListener(MakeExecutionListener(sequential));
+    batchBook.SetExecutionListener(MakeExecutionListener(batch));
+
+    for (const auto &request : requests)
+        sequentialBook.SubmitOrder(request);
+    // Uneven bursts, so batches start on arbitrary book states
+    for (size_t begin = 0; begin < requests.size();) {
+        const size_t count = std::min<size_t>(1 + random() % 64, requests.size() - begin);
+        batchBook.SubmitOrders(std::span(requests).subspan(begin, count));
+        begin += count;
+    }
+
+    EXPECT_EQ(batch.events, sequential.events);
+    EXPECT_EQ(batchBook.Size(), sequentialBook.Size());
+    auto sequentialLevels = sequentialBook.GetOrderBookLevelInfos();
+    auto batchLevels = batchBook.GetOrderBookLevelInfos();
+    ASSERT_EQ(batchLevels.GetBids().size(), sequentialLevels.GetBids().size());
+    for (size_t i = 0; i < batchLevels.GetBids().size(); ++i) {
+        EXPECT_EQ(batchLevels.GetBids()[i].price_, sequentialLevels.GetBids()[i].price_);
+        EXPECT_EQ(batchLevels.GetBids()[i].quantity_, sequentialLevels.GetBids()[i].quantity_);
+    }
+}
+
+TEST(ExecutionListenerTest, BatchAddAndCancel) {
+    OrderBook orderBook;
+    RecordingSink sink;
+    orderBook.SetExecutionListener(MakeExecutionListener(sink));
+
+    const OrderRequest requests[] = {
+        {OrderType::GoodTillCancel, 1, Side::Sell, 100, 5},
+        {OrderType::GoodTillCancel, 2, Side::Sell, 100, 5},
+        {OrderType::GoodTillCancel, 3, Side::Buy, 100, 7},
+        {OrderType::GoodTillCancel, 4, Side::Buy, 99, 1},
+    };
+    auto trades = orderBook.AddOrders(requests);
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[1].GetAskTrade().orderId_, 2);
+
+    const OrderId cancels[] = {2, 4, 42};
+    orderBook.CancelOrders(cancels);
+
+    EXPECT_EQ(sink.events, (std::vector<std::string>{"ack 1", "ack 2", "ack 3", "trade 3/1 5", "trade 3/2 2", "ack 4",
+                                                     "cancel 2 3", "cancel 4 1"}));
+    EXPECT_EQ(orderBook.Size(), 0);
+}
+
+// Collects each flush separately so the per command grouping can be checked
+struct DepthSink {
+    std::vector<std::vector<LevelUpdate>> flushes;
+    void OnLevelUpdates(std::span<const LevelUpdate> updates) { flushes.emplace_back(updates.begin(), updates.end()); }
+};
+
+bool operator==(const LevelUpdate &a, const LevelUpdate &b) {
+    return a.side_ == b.side_ && a.price_ == b.price_ && a.quantity_ == b.quantity_ && a.count_ == b.count_;
+}
+
+TEST(ExecutionListenerTest, LevelUpdatesAreCoalescedPerCommand) {
+    OrderBook orderBook;
+    DepthSink sink;
+    orderBook.SetExecutionListener(MakeExecutionListener(sink));
+
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 101, 5});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 101, 5});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 3, Side::Sell, 102, 5});
+    ASSERT_EQ(sink.flushes.size(), 3);
+    EXPECT_EQ(sink.flushes[1], (std::vector<LevelUpdate>{{Side::Sell, 101, 10, 2}}));
+
+    // Sweeps two levels with three fills: one update per level, the emptied one with count 0
+    // The buy order never joins a level of its own, so nothing is reported for the bid side
+    sink.flushes.clear();
+    orderBook.SubmitOrder(OrderRequest{OrderType::FillAndKill, 4, Side::Buy, 102, 12});
+    ASSERT_EQ(sink.flushes.size(), 1);
+    EXPECT_EQ(sink.flushes[0], (std::vector<LevelUpdate>{{Side::Sell, 101, 0, 0}, {Side::Sell, 102, 3, 1}}));
+
+    // A modify is one command: old level and new level together
+    sink.flushes.clear();
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 5, Side::Buy, 99, 4});
+    orderBook.SubmitModify(OrderModify(5, Side::Buy, 100, 4));
+    ASSERT_EQ(sink.flushes.size(), 2);
+    EXPECT_EQ(sink.flushes[1], (std::vector<LevelUpdate>{{Side::Buy, 100, 4, 1}, {Side::Buy, 99, 0, 0}}));
+
+    // Nothing changed, nothing sent
+    sink.flushes.clear();
+    orderBook.CancelOrder(42);
+    EXPECT_TRUE(sink.flushes.empty());
+}
+
+TEST(ExecutionListenerTest, LevelUpdatesOncePerBatch) {
+    OrderBook orderBook;
+    DepthSink sink;
+    orderBook.SetExecutionListener(MakeExecutionListener(sink));
+
+    std::vector<OrderRequest> requests;
+    for (OrderId orderId = 0; orderId < 100; ++orderId)
+        requests.push_back(OrderRequest{OrderType::GoodTillCancel, orderId, Side::Buy, 90 + orderId % 3, 1});
+    orderBook.SubmitOrders(requests);
+
+    ASSERT_EQ(sink.flushes.size(), 1);
+    EXPECT_EQ(sink.flushes[0], (std::vector<LevelUpdate>{{Side::Buy, 92, 33, 33}, {Side::Buy, 91, 33, 33}, {Side::Buy, 90, 34, 34}}));
+
+    const OrderId cancels[] = {0, 3, 6};
+    orderBook.CancelOrders(cancels);
+    ASSERT_EQ(sink.flushes.size(), 2);
+    EXPECT_EQ(sink.flushes[1], (std::vector<LevelUpdate>{{Side::Buy, 90, 31, 31}}));
+}
+
+// A consumer that only applies the deltas ends up with exactly the book's depth
+TEST(ExecutionListenerTest, LevelUpdatesRebuildTheBook) {
+    struct MirrorSink {
+        std::map<std::pair<Side, Price>, std::pair<Quantity, Quantity>> levels;
+        void OnLevelUpdates(std::span<const LevelUpdate> updates) {
+            for (const auto &update : updates) {
+                if (update.count_ == 0)
+                    levels.erase({update.side_, update.price_});
+                else
+                    levels[{update.side_, update.price_}] = {update.quantity_, update.count_};
+            }
+        }
+    };
+
+    OrderBook orderBook;
+    MirrorSink mirror;
+    orderBook.SetExecutionListener(MakeExecutionListener(mirror));
+
+    std::mt19937 random(7);
+    const OrderType types[] = {OrderType::GoodTillCancel, OrderType::GoodForDay, OrderType::FillAndKill,
+                               OrderType::FillOrKill, OrderType::Market};
+    for (OrderId orderId = 0; orderId < 3000; ++orderId) {
+        const Side side = random() % 2 ? Side::Buy : Side::Sell;
+        const auto price = static_cast<Price>(95 + random() % 10);
+        switch (random() % 4) {
+        case 0:
+            orderBook.CancelOrder(static_cast<OrderId>(random() % (orderId + 1)));
+            break;
+        case 1:
+            orderBook.SubmitModify(OrderModify(static_cast<OrderId>(random() % (orderId + 1)), side, price, 1 + random() % 10));
+            break;
+        default:
+            orderBook.SubmitOrder(OrderRequest{types[random() % 5], orderId, side, price, static_cast<Quantity>(1 + random() % 20)});
+        }
+    }
+    orderBook.CancelGoodForDayOrders();
+
+    std::map<std::pair<Side, Price>, std::pair<Quantity, Quantity>> expected;
+    const auto infos = orderBook.GetOrderBookLevelInfos();
+    for (const auto &level : infos.GetBids())
+        expected[{Side::Buy, level.price_}] = {level.quantity_, level.count_};
+    for (const auto &level : infos.GetAsks())
+        expected[{Side::Sell, level.price_}] = {level.quantity_, level.count_};
+    EXPECT_EQ(mirror.levels, expected);
+}
+
+struct OrderEventSink {
+    std::vector<OrderEvent> events;
+    void OnOrderEvent(const OrderEvent &event) { events.push_back(event); }
+};
+
+TEST(ExecutionListenerTest, OrderEventsOnlyInL3Builds) {
+    OrderBook orderBook;
+    OrderEventSink sink;
+    orderBook.SetExecutionListener(MakeExecutionListener(sink));
+
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5});
+    EXPECT_EQ(sink.events.size(), OrderEventsEnabled ? 1u : 0u);
+}
+
+TEST(ExecutionListenerTest, OrderEventsCarryQueuePositionsAndSequence) {
+    if (!OrderEventsEnabled)
+        GTEST_SKIP() << "built without ORDERBOOK_L3_FEED";
+
+    OrderBook orderBook;
+    OrderEventSink sink;
+    orderBook.SetExecutionListener(MakeExecutionListener(sink));
+
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 100, 5});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 3, Side::Buy, 100, 7});
+    orderBook.CancelOrder(2);
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 4, Side::Sell, 101, 6});
+    orderBook.SubmitModify(OrderModify(4, Side::Sell, 101, 2));
+
+    auto is = [](const OrderEvent &event, OrderEventType type, OrderId orderId, Quantity quantity, Quantity remaining, uint32_t position) {
+        return event.type_ == type && event.orderId_ == orderId && event.quantity_ == quantity &&
+               event.remainingQuantity_ == remaining && event.queuePosition_ == position;
+    };
+    ASSERT_EQ(sink.events.size(), 10);
+    EXPECT_TRUE(is(sink.events[0], OrderEventType::Add, 1, 5, 5, 0));
+    EXPECT_TRUE(is(sink.events[1], OrderEventType::Add, 2, 5, 5, 1));
+    EXPECT_TRUE(is(sink.events[2], OrderEventType::Add, 3, 7, 7, 0));
+    EXPECT_EQ(sink.events[2].GetSide(), Side::Buy);
+    EXPECT_TRUE(is(sink.events[3], OrderEventType::Execute, 3, 5, 2, 0));
+    EXPECT_TRUE(is(sink.events[4], OrderEventType::Execute, 1, 5, 0, 0));
+    EXPECT_TRUE(is(sink.events[5], OrderEventType::Execute, 3, 2, 0, 0));
+    EXPECT_TRUE(is(sink.events[6], OrderEventType::Execute, 2, 2, 3, 0));
+    EXPECT_TRUE(is(sink.events[7], OrderEventType::Delete, 2, 3, 3, OrderEvent::NoQueuePosition));
+    EXPECT_TRUE(is(sink.events[8], OrderEventType::Add, 4, 6, 6, 0));
+    EXPECT_TRUE(is(sink.events[9], OrderEventType::Reduce, 4, 4, 2, OrderEvent::NoQueuePosition));
+    for (size_t i = 0; i < sink.events.size(); ++i)
+        EXPECT_EQ(sink.events[i].sequence_, i + 1);
+}
+
+// Applying the L3 events alone reproduces every level, order by order in queue order
+TEST(ExecutionListenerTest, OrderEventsRebuildTheQueues) {
+    if (!OrderEventsEnabled)
+        GTEST_SKIP() << "built without ORDERBOOK_L3_FEED";
+
+    struct MirrorSink {
+        std::map<std::pair<Side, Price>, std::vector<std::pair<OrderId, Quantity>>> levels;
+        uint64_t lastSequence = 0;
+        bool inSequence = true;
+        void OnOrderEvent(const OrderEvent &event) {
+            inSequence = inSequence && event.sequence_ == lastSequence + 1;
+            lastSequence = event.sequence_;
+            auto &queue = levels[{event.GetSide(), event.price_}];
+            if (event.type_ == OrderEventType::Add) {
+                ASSERT_EQ(event.queuePosition_, queue.size());
+                queue.emplace_back(event.orderId_, event.remainingQuantity_);
+                return;
+            }
+            auto order = std::find_if(queue.begin(), queue.end(), [&](const auto &entry) { return entry.first == event.orderId_; });
+            ASSERT_NE(order, queue.end());
+            if (event.type_ == OrderEventType::Execute) {
+                ASSERT_EQ(order, queue.begin());
+            }
+            if (event.remainingQuantity_ == 0 || event.type_ == OrderEventType::Delete)
+                queue.erase(order);
+            else
+                order->second = event.remainingQuantity_;
+            if (queue.empty())
+                levels.erase({event.GetSide(), event.price_});
+        }
+    };
+
+    OrderBook orderBook;
+    MirrorSink mirror;
+    orderBook.SetExecutionListener(MakeExecutionListener(mirror));
+
+    std::mt19937 random(11);
+    const OrderType types[] = {OrderType::GoodTillCancel, OrderType::GoodForDay, OrderType::FillAndKill,
+                               OrderType::FillOrKill, OrderType::Market};
+    for (OrderId orderId = 0; orderId < 3000; ++orderId) {
+        const Side side = random() % 2 ? Side::Buy : Side::Sell;
+        const auto price = static_cast<Price>(95 + random() % 10);
+        switch (random() % 4) {
+        case 0:
+            orderBook.CancelOrder(static_cast<OrderId>(random() % (orderId + 1)));
+            break;
+        case 1:
+            orderBook.SubmitModify(OrderModify(static_cast<OrderId>(random() % (orderId + 1)), side, price, 1 + random() % 10));
+            break;
+        default:
+            orderBook.SubmitOrder(OrderRequest{types[random() % 5], orderId, side, price, static_cast<Quantity>(1 + random() % 20)});
+        }
+    }
+    orderBook.CancelGoodForDayOrders();
+    EXPECT_TRUE(mirror.inSequence);
+
+    // Order of each queue was checked by every Execute hitting its front, the totals have to agree too
+    std::map<std::pair<Side, Price>, std::pair<Quantity, Quantity>> expected, mirrored;
+    const auto infos = orderBook.GetOrderBookLevelInfos();
+    for (const auto &level : infos.GetBids())
+        expected[{Side::Buy, level.price_}] = {level.quantity_, level.count_};
+    for (const auto &level : infos.GetAsks())
+        expected[{Side::Sell, level.price_}] = {level.quantity_, level.count_};
+    for (const auto &[key, queue] : mirror.levels) {
+        Quantity total = 0;
+        for (const auto &entry : queue)
+            total += entry.second;
+        mirrored[key] = {total, static_cast<Quantity>(queue.size())};
+    }
+    EXPECT_EQ(mirrored, expected);
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../Gateway.h"
+#include "../LoadGenerator.h"
+
+namespace {
+    // Gateway on a free loopback port, served from its own thread until Stop
+    struct RunningGateway {
+        Gateway gateway;
+        std::thread thread;
+        explicit RunningGateway(const GatewayConfig &config = {}) : gateway{config}, thread{[this] { gateway.Run(); }} {}
+        ~RunningGateway() { Stop(); }
+        void Stop() {
+            if (!thread.joinable())
+                return;
+            gateway.Stop();
+            thread.join();
+        }
+    };
+
+    int Connect(uint16_t port) {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        EXPECT_EQ(::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)), 0);
+        return fd;
+    }
+
+    void Send(int fd, const void *data, size_t size) {
+        ASSERT_EQ(::send(fd, data, size, MSG_NOSIGNAL), static_cast<ssize_t>(size));
+    }
+
+    // Reads exactly `count` reports, whichever requests they belong to
+    std::vector<GatewayReport> ReadCount(int fd, size_t count) {
+        std::vector<GatewayReport> reports(count);
+        for (auto &report : reports)
+            EXPECT_EQ(::recv(fd, &report, sizeof(report), MSG_WAITALL), static_cast<ssize_t>(sizeof(report)));
+        return reports;
+    }
+
+    // Reads until `requests` requests have had their last report
+    std::vector<GatewayReport> ReadReports(int fd, size_t requests) {
+        std::vector<GatewayReport> reports;
+        GatewayReport report;
+        size_t last = 0;
+        while (last < requests && ::recv(fd, &report, sizeof(report), MSG_WAITALL) == sizeof(report)) {
+            reports.push_back(report);
+            last += report.IsLast();
+        }
+        return reports;
+    }
+}
+
+TEST(GatewayTest, RoundTripsRequestsAndReports) {
+    RunningGateway running;
+    const int fd = Connect(running.gateway.Port());
+
+    // Three requests in one write
+    const GatewayRequest requests[] = {
+        GatewayRequest::From(1, EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5})),
+        GatewayRequest::From(2, EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 3})),
+        GatewayRequest::From(3, EngineCommand::Cancel(99)),
+    };
+    Send(fd, requests, sizeof(requests));
+    // And one cut in two by the stream
+    const GatewayRequest cancel = GatewayRequest::From(4, EngineCommand::Cancel(1));
+    const auto *bytes = reinterpret_cast<const unsigned char *>(&cancel);
+    Send(fd, bytes, 10);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    Send(fd, bytes + 10, sizeof(cancel) - 10);
+
+    const auto reports = ReadReports(fd, 4);
+    ASSERT_EQ(reports.size(), 5u);
+    auto is = [](const GatewayReport &report, uint64_t tag, uint8_t type, OrderId orderId, Quantity quantity, bool last) {
+        return report.clientTag_ == tag && report.reportType_ == type && report.orderId_ == orderId &&
+               report.quantity_ == quantity && report.IsLast() == last;
+    };
+    EXPECT_TRUE(is(reports[0], 1, static_cast<uint8_t>(ReportType::Accepted), 1, 0, true));
+    EXPECT_TRUE(is(reports[1], 2, static_cast<uint8_t>(ReportType::Accepted), 2, 0, false));
+    EXPECT_TRUE(is(reports[2], 2, static_cast<uint8_t>(ReportType::Trade), 2, 3, true));
+    EXPECT_EQ(reports[2].askOrderId_, 1);
+    EXPECT_EQ(reports[2].askPrice_, 100);
+    // Nothing to cancel, the request still gets its last report
+    EXPECT_TRUE(is(reports[3], 3, GatewayReport::Done, 99, 0, true));
+    EXPECT_TRUE(is(reports[4], 4, static_cast<uint8_t>(ReportType::Cancelled), 1, 2, true));
+
+    ::close(fd);
+    running.Stop();
+    const auto &stats = running.gateway.GetStats();
+    EXPECT_EQ(stats.connections_, 1u);
+    EXPECT_EQ(stats.requests_, 4u);
+    EXPECT_EQ(stats.reports_, 5u);
+    EXPECT_EQ(running.gateway.GetOrderBook().Size(), 0u);
+}
+
+TEST(GatewayTest, ReportsGoToTheOrdersOwner) {
+    RunningGateway running;
+    const int resting = Connect(running.gateway.Port());
+    const int other = Connect(running.gateway.Port());
+
+    const auto sell = GatewayRequest::From(1, EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5}));
+    Send(resting, &sell, sizeof(sell));
+    ASSERT_EQ(ReadReports(resting, 1).size(), 1u);
+
+    // Only the connection that added an order may cancel or modify it
+    const GatewayRequest notOwned[] = {
+        GatewayRequest::From(10, EngineCommand::Cancel(1)),
+        GatewayRequest::From(11, EngineCommand::Modify(OrderModify(1, Side::Sell, 101, 5))),
+    };
+    Send(other, notOwned, sizeof(notOwned));
+    const auto rejected = ReadReports(other, 2);
+    ASSERT_EQ(rejected.size(), 2u);
+    for (const auto &report : rejected) {
+        EXPECT_EQ(report.reportType_, static_cast<uint8_t>(ReportType::Rejected));
+        EXPECT_EQ(report.reason_, static_cast<uint8_t>(RejectReason::NotOrderOwner));
+        EXPECT_EQ(report.orderId_, 1);
+    }
+
+    // The fill reaches the resting order's owner too, with the tag of its own add
+    const auto buy = GatewayRequest::From(20, EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 3}));
+    Send(other, &buy, sizeof(buy));
+    const auto aggressor = ReadReports(other, 1);
+    ASSERT_EQ(aggressor.size(), 2u);
+    EXPECT_EQ(aggressor[1].reportType_, static_cast<uint8_t>(ReportType::Trade));
+    const auto fill = ReadCount(resting, 1);
+    EXPECT_EQ(fill[0].reportType_, static_cast<uint8_t>(ReportType::Trade));
+    EXPECT_EQ(fill[0].clientTag_, 1u);
+    EXPECT_EQ(fill[0].askOrderId_, 1);
+    EXPECT_EQ(fill[0].quantity_, 3);
+    EXPECT_FALSE(fill[0].IsLast());
+
+    // The owner still can cancel what is left
+    const auto cancel = GatewayRequest::From(2, EngineCommand::Cancel(1));
+    Send(resting, &cancel, sizeof(cancel));
+    const auto cancelled = ReadReports(resting, 1);
+    ASSERT_EQ(cancelled.size(), 1u);
+    EXPECT_EQ(cancelled[0].reportType_, static_cast<uint8_t>(ReportType::Cancelled));
+    EXPECT_EQ(cancelled[0].quantity_, 2);
+
+    ::close(resting);
+    ::close(other);
+    running.Stop();
+    EXPECT_EQ(running.gateway.GetOrderBook().Size(), 0u);
+}
+
+TEST(GatewayTest, ExpiryCancelsReachTheOwner) {
+    RunningGateway running;
+    const int fd = Connect(running.gateway.Port());
+
+    // Already past its expiry, the loop cancels it after the batch
+    const auto add = GatewayRequest::From(7, EngineCommand::Add(OrderRequest{OrderType::GoodTillTime, 1, Side::Buy, 100, 4, ExpiryTime{std::chrono::seconds{1}}}));
+    Send(fd, &add, sizeof(add));
+    ASSERT_EQ(ReadReports(fd, 1).size(), 1u);
+    const auto expired = ReadCount(fd, 1);
+    EXPECT_EQ(expired[0].reportType_, static_cast<uint8_t>(ReportType::Cancelled));
+    EXPECT_EQ(expired[0].clientTag_, 7u);
+    EXPECT_EQ(expired[0].quantity_, 4);
+
+    ::close(fd);
+}
+
+TEST(GatewayTest, MalformedRequestClosesTheConnection) {
+    RunningGateway running;
+    const int fd = Connect(running.gateway.Port());
+
+    GatewayRequest request = GatewayRequest::From(1, EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5}));
+    request.side_ = 7;
+    Send(fd, &request, sizeof(request));
+    char byte;
+    EXPECT_EQ(::recv(fd, &byte, 1, 0), 0);
+
+    ::close(fd);
+    running.Stop();
+    EXPECT_EQ(running.gateway.GetStats().protocolErrors_, 1u);
+    EXPECT_EQ(running.gateway.GetOrderBook().Size(), 0u);
+}
+
+// Two clients at once, one request at a time and 32 in flight: every request's last report
+// comes back to the client that sent it, and a window's worth of requests is read in far fewer reads
+TEST(GatewayTest, LoadGeneratorsGetEveryRoundTrip) {
+    RunningGateway running;
+    LoadGeneratorConfig single{.port_ = running.gateway.Port(), .requests_ = 2000, .window_ = 1};
+    LoadGeneratorConfig windowed{.port_ = running.gateway.Port(), .requests_ = 20000, .firstOrderId_ = 100000, .window_ = 32, .seed_ = 2};
+    LoadGeneratorResult singleResult, windowedResult;
+
+    std::thread other([&] { singleResult = RunLoadGenerator(single); });
+    windowedResult = RunLoadGenerator(windowed);
+    other.join();
+    running.Stop();
+
+    EXPECT_EQ(singleResult.requests_, 2000u);
+    EXPECT_EQ(singleResult.roundTrip_.Count(), 2000u);
+    EXPECT_EQ(windowedResult.roundTrip_.Count(), 20000u);
+    EXPECT_GT(windowedResult.trades_, 0u);
+    EXPECT_GT(windowedResult.roundTrip_.Min(), 0u);
+
+    const auto &stats = running.gateway.GetStats();
+    EXPECT_EQ(stats.connections_, 2u);
+    EXPECT_EQ(stats.requests_, 22000u);
+    // A fill of a client's resting order can come after that client has read its last round trip
+    EXPECT_GE(stats.reports_, singleResult.reports_ + windowedResult.reports_);
+    EXPECT_LT(stats.reads_, stats.requests_);
+}
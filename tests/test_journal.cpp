@@ -0,0 +1,344 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include "../Journal.h"
+#include "../MatchingEngine.h"
+#include "../OrderBook.h"
+#include "../Snapshot.h"
+
+namespace {
+    // Fresh file path per test, removed again at the end
+    struct TempFile {
+        std::string path;
+        explicit TempFile(const std::string &name)
+            : path{(std::filesystem::temp_directory_path() / ("orderbook_" + name)).string()} {
+            std::filesystem::remove(path);
+        }
+        ~TempFile() { std::filesystem::remove(path); }
+    };
+
+    void ExpectSameBook(const OrderBook &expected, const OrderBook &actual) {
+        EXPECT_EQ(actual.Size(), expected.Size());
+        auto expectedLevels = expected.GetOrderBookLevelInfos();
+        auto actualLevels = actual.GetOrderBookLevelInfos();
+        ASSERT_EQ(actualLevels.GetBids().size(), expectedLevels.GetBids().size());
+        ASSERT_EQ(actualLevels.GetAsks().size(), expectedLevels.GetAsks().size());
+        for (size_t i = 0; i < actualLevels.GetBids().size(); ++i) {
+            EXPECT_EQ(actualLevels.GetBids()[i].price_, expectedLevels.GetBids()[i].price_);
+            EXPECT_EQ(actualLevels.GetBids()[i].quantity_, expectedLevels.GetBids()[i].quantity_);
+        }
+        for (size_t i = 0; i < actualLevels.GetAsks().size(); ++i) {
+            EXPECT_EQ(actualLevels.GetAsks()[i].price_, expectedLevels.GetAsks()[i].price_);
+            EXPECT_EQ(actualLevels.GetAsks()[i].quantity_, expectedLevels.GetAsks()[i].quantity_);
+        }
+    }
+}
+
+TEST(JournalTest, ReplayRebuildsTheBook) {
+    TempFile file("replay.journal");
+    OrderBook live(OrderBookConfig{.startPruneThread_ = false});
+    {
+        // Tiny initial size so the file has to grow a few times
+        Journal journal(JournalConfig{.path_ = file.path, .initialRecords_ = 4, .groupCommitRecords_ = 16});
+        for (OrderId orderId = 0; orderId < 300; ++orderId) {
+            const Side side = orderId % 2 ? Side::Sell : Side::Buy;
+            EngineCommand command = EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, orderId, side, 100 + orderId % 7 - 3, 10});
+            if (orderId % 5 == 4)
+                command = EngineCommand::Cancel(orderId - 2);
+            else if (orderId % 11 == 10)
+                command = EngineCommand::Modify(OrderModify(orderId - 4, Side::Buy, 90, 3));
+            EXPECT_EQ(journal.Append(command), static_cast<uint64_t>(orderId + 1));
+            live.SubmitCommand(command);
+        }
+    }
+
+    Journal reopened(JournalConfig{.path_ = file.path});
+    EXPECT_EQ(reopened.RecoveredCount(), 300);
+    OrderBook recovered(OrderBookConfig{.startPruneThread_ = false});
+    EXPECT_EQ(reopened.Replay(recovered), 300);
+    ExpectSameBook(live, recovered);
+
+    // Appends carry on after the recovered records
+    EXPECT_EQ(reopened.Append(EngineCommand::Cancel(0)), 301);
+}
+
+TEST(JournalTest, TornTailIsDropped) {
+    TempFile file("torn.journal");
+    {
+        Journal journal(JournalConfig{.path_ = file.path, .initialRecords_ = 64});
+        for (OrderId orderId = 1; orderId <= 10; ++orderId)
+            journal.Append(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, orderId, Side::Buy, 100, 1}));
+    }
+
+    // Scribble over the middle of record 8 as if the crash hit while it was being written
+    {
+        std::fstream stream(file.path, std::ios::in | std::ios::out | std::ios::binary);
+        stream.seekp(64 + 7 * sizeof(JournalRecord) + 12);
+        stream.put('\x7f');
+    }
+
+    Journal journal(JournalConfig{.path_ = file.path});
+    EXPECT_EQ(journal.RecoveredCount(), 7);
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    journal.Replay(orderBook);
+    EXPECT_EQ(orderBook.Size(), 7);
+
+    // Next append reuses the torn slot and a later recovery sees it
+    EXPECT_EQ(journal.Append(EngineCommand::Cancel(1)), 8);
+}
+
+TEST(JournalTest, RejectsForeignFile) {
+    TempFile file("foreign.journal");
+    {
+        std::ofstream stream(file.path, std::ios::binary);
+        stream << std::string(128, 'x');
+    }
+    EXPECT_THROW(Journal(JournalConfig{.path_ = file.path}), std::runtime_error);
+}
+
+TEST(JournalTest, MatchingEngineRecoversFromJournal) {
+    TempFile file("engine.journal");
+    MatchingEngineConfig config{.journal_ = JournalConfig{.path_ = file.path}};
+    {
+        MatchingEngine engine(config);
+        engine.Submit(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 101, 5}));
+        engine.Submit(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 99, 5}));
+        engine.Submit(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 3, Side::Buy, 101, 2}));
+        engine.Stop();
+    }
+
+    MatchingEngine restarted(config);
+    restarted.Submit(EngineCommand::Cancel(2));
+    restarted.Stop();
+
+    // Recovery itself is silent, only the new cancel is reported
+    std::vector<ReportType> types;
+    restarted.PollReports([&](const ExecutionReport &report) { types.push_back(report.type_); });
+    EXPECT_EQ(types, std::vector<ReportType>{ReportType::Cancelled});
+
+    LevelInfo asks[1];
+    ASSERT_EQ(restarted.GetOrderBook().GetTopLevels(Side::Sell, 1, asks), 1);
+    EXPECT_EQ(asks[0].quantity_, 3);
+    EXPECT_EQ(restarted.GetOrderBook().Size(), 1);
+}
+
+TEST(JournalTest, ExpiredOrdersStayExpiredAfterReplay) {
+    TempFile file("expiry_replay.journal");
+    MatchingEngineConfig config{.journal_ = JournalConfig{.path_ = file.path}};
+    {
+        MatchingEngine engine(config);
+        // Already past its expiry, the matching thread expires it the next time it is idle
+        engine.Submit(EngineCommand::Add(OrderRequest{OrderType::GoodTillTime, 1, Side::Sell, 100, 5, ExpiryTime{std::chrono::seconds{1}}}));
+        bool expired = false;
+        while (!expired)
+            engine.PollReports([&](const ExecutionReport &report) { expired |= report.type_ == ReportType::Cancelled; });
+        // Would have traded with the expired order had it come back
+        engine.Submit(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 5}));
+        engine.Stop();
+        EXPECT_EQ(engine.GetOrderBook().Size(), 1);
+    }
+
+    Journal journal(JournalConfig{.path_ = file.path});
+    OrderBook recovered(OrderBookConfig{.startPruneThread_ = false});
+    journal.Replay(recovered);
+    EXPECT_EQ(recovered.Size(), 1);
+    LevelInfo bids[1];
+    ASSERT_EQ(recovered.GetTopLevels(Side::Buy, 1, bids), 1);
+    EXPECT_EQ(bids[0].quantity_, 5);
+}
+
+TEST(SnapshotTest, RoundTripKeepsQueueOrder) {
+    TempFile file("roundtrip.snapshot");
+    OrderBook original(OrderBookConfig{.ladderMinPrice_ = 90, .ladderLevels_ = 20, .startPruneThread_ = false});
+    // Prices on both sides of the ladder band so overflow and ladder levels are both covered
+    for (OrderId orderId = 1; orderId <= 40; ++orderId) {
+        const Side side = orderId % 2 ? Side::Sell : Side::Buy;
+        const Price price = side == Side::Buy ? 100 - orderId % 15 * 2 : 101 + orderId % 15 * 2;
+        const OrderType type = orderId % 3 ? OrderType::GoodTillCancel : OrderType::GoodForDay;
+        original.SubmitOrder(OrderRequest{type, orderId, side, price, orderId});
+    }
+    // Partially fill the front of the best bid
+    original.SubmitOrder(OrderRequest{OrderType::FillAndKill, 100, Side::Sell, 98, 3});
+    original.SaveSnapshot(file.path, 1234);
+
+    OrderBook loaded(OrderBookConfig{.ladderMinPrice_ = 90, .ladderLevels_ = 20, .startPruneThread_ = false});
+    EXPECT_EQ(loaded.LoadSnapshot(file.path), 1234);
+    ExpectSameBook(original, loaded);
+
+    // Same queue positions: an aggressive order fills the same orders in the same order on both books
+    auto expected = original.AddOrder(OrderRequest{OrderType::GoodTillCancel, 200, Side::Sell, 80, 150});
+    auto actual = loaded.AddOrder(OrderRequest{OrderType::GoodTillCancel, 200, Side::Sell, 80, 150});
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_EQ(actual[i].GetBidTrade().orderId_, expected[i].GetBidTrade().orderId_);
+        EXPECT_EQ(actual[i].GetBidTrade().quantity_, expected[i].GetBidTrade().quantity_);
+    }
+
+    // Order types survive: only the GoodForDay ones go at the close
+    original.CancelGoodForDayOrders();
+    loaded.CancelGoodForDayOrders();
+    ExpectSameBook(original, loaded);
+}
+
+TEST(SnapshotTest, GoodTillTimeExpiryRoundTrips) {
+    using namespace std::chrono;
+    TempFile journalFile("expiry.journal");
+    TempFile snapshotFile("expiry.snapshot");
+    const ExpiryTime expiry = sys_days{2026y / 3 / 2} + 16h;
+    OrderBook original(OrderBookConfig{.startPruneThread_ = false});
+    {
+        Journal journal(JournalConfig{.path_ = journalFile.path, .sync_ = false});
+        for (OrderId orderId = 1; orderId <= 4; ++orderId) {
+            const auto command = EngineCommand::Add(OrderRequest{OrderType::GoodTillTime, orderId, Side::Buy, 100, 5, expiry + seconds(orderId % 2)});
+            journal.Append(command);
+            original.SubmitCommand(command);
+        }
+    }
+    original.SaveSnapshot(snapshotFile.path);
+
+    OrderBook fromJournal(OrderBookConfig{.startPruneThread_ = false});
+    Journal(JournalConfig{.path_ = journalFile.path}).Replay(fromJournal);
+    OrderBook fromSnapshot(OrderBookConfig{.startPruneThread_ = false});
+    fromSnapshot.LoadSnapshot(snapshotFile.path);
+
+    for (OrderBook *orderBook : {&original, &fromJournal, &fromSnapshot}) {
+        EXPECT_EQ(orderBook->ExpireOrders(expiry), 2);
+        EXPECT_EQ(orderBook->ExpireOrders(expiry + 1s), 2);
+        EXPECT_EQ(orderBook->Size(), 0);
+    }
+}
+
+TEST(SnapshotTest, LoadedGoodTillTimeOrdersWakeThePruneThread) {
+    using namespace std::chrono;
+    TempFile file("prune.snapshot");
+    const ExpiryTime expiry = ceil<seconds>(system_clock::now()) + 1s;
+    {
+        OrderBook original(OrderBookConfig{.startPruneThread_ = false});
+        original.SubmitOrder(OrderRequest{OrderType::GoodTillTime, 1, Side::Buy, 100, 5, expiry});
+        original.SaveSnapshot(file.path);
+    }
+
+    // The prune thread is already asleep until the close when the order arrives
+    OrderBook loaded;
+    std::this_thread::sleep_for(100ms);
+    loaded.LoadSnapshot(file.path);
+    EXPECT_EQ(loaded.Size(), 1);
+    const auto deadline = steady_clock::now() + 10s;
+    while (loaded.Size() != 0 && steady_clock::now() < deadline)
+        std::this_thread::sleep_for(10ms);
+    EXPECT_EQ(loaded.Size(), 0);
+}
+
+TEST(SnapshotTest, StopOrdersRoundTrip) {
+    TempFile journalFile("stops.journal");
+    TempFile snapshotFile("stops.snapshot");
+    OrderBook original(OrderBookConfig{.startPruneThread_ = false});
+    {
+        Journal journal(JournalConfig{.path_ = journalFile.path, .sync_ = false});
+        const EngineCommand commands[] = {
+            EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 1}),
+            EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 1}),
+            EngineCommand::Add(OrderRequest{OrderType::StopLimit, 3, Side::Buy, 103, 4, {}, 102}),
+            EngineCommand::Add(OrderRequest{OrderType::Stop, 4, Side::Buy, 0, 2, {}, 101}),
+            EngineCommand::Add(OrderRequest{OrderType::Stop, 5, Side::Sell, 0, 2, {}, 95}),
+            EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 6, Side::Sell, 103, 10}),
+        };
+        for (const auto &command : commands) {
+            journal.Append(command);
+            original.SubmitCommand(command);
+        }
+    }
+    original.SaveSnapshot(snapshotFile.path);
+
+    OrderBook fromJournal(OrderBookConfig{.startPruneThread_ = false});
+    Journal(JournalConfig{.path_ = journalFile.path}).Replay(fromJournal);
+    OrderBook fromSnapshot(OrderBookConfig{.startPruneThread_ = false});
+    fromSnapshot.LoadSnapshot(snapshotFile.path);
+
+    for (OrderBook *orderBook : {&original, &fromJournal, &fromSnapshot}) {
+        EXPECT_EQ(orderBook->GetLastTradePrice(), 100);
+        EXPECT_EQ(orderBook->Size(), 4);
+        // Trades at 102, 4 triggers first (stop 101) and takes at 103, then 3 (stop 102, limit 103)
+        orderBook->SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 7, Side::Sell, 102, 1});
+        auto trades = orderBook->AddOrder(OrderRequest{OrderType::FillAndKill, 8, Side::Buy, 102, 1});
+        ASSERT_EQ(trades.size(), 3);
+        EXPECT_EQ(trades[1].GetBidTrade().orderId_, 4);
+        EXPECT_EQ(trades[2].GetBidTrade().orderId_, 3);
+        EXPECT_EQ(trades[2].GetBidTrade().quantity_, 4);
+        EXPECT_EQ(orderBook->Size(), 2);
+    }
+}
+
+TEST(SnapshotTest, BadFilesLeaveTheBookEmpty) {
+    TempFile file("bad.snapshot");
+    {
+        OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+        orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 5});
+        orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 99, 5});
+        orderBook.SaveSnapshot(file.path);
+    }
+
+    // Break the second level's total
+    {
+        std::fstream stream(file.path, std::ios::in | std::ios::out | std::ios::binary);
+        stream.seekp(sizeof(SnapshotHeader) + sizeof(SnapshotLevel) + sizeof(SnapshotOrder) + offsetof(SnapshotLevel, quantity_));
+        stream.put('\x09');
+    }
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    EXPECT_THROW(orderBook.LoadSnapshot(file.path), std::runtime_error);
+    EXPECT_EQ(orderBook.Size(), 0);
+    EXPECT_TRUE(orderBook.GetOrderBookLevelInfos().GetBids().empty());
+
+    // Both orders with the same id
+    {
+        std::fstream stream(file.path, std::ios::in | std::ios::out | std::ios::binary);
+        stream.seekp(sizeof(SnapshotHeader) + sizeof(SnapshotLevel) + sizeof(SnapshotOrder) + offsetof(SnapshotLevel, quantity_));
+        stream.put('\x05');
+        stream.seekp(sizeof(SnapshotHeader) + 2 * sizeof(SnapshotLevel) + sizeof(SnapshotOrder) + offsetof(SnapshotOrder, orderId_));
+        stream.put('\x01');
+    }
+    EXPECT_THROW(orderBook.LoadSnapshot(file.path), std::runtime_error);
+    EXPECT_EQ(orderBook.Size(), 0);
+    EXPECT_TRUE(orderBook.GetOrderBookLevelInfos().GetBids().empty());
+
+    // Cut short
+    std::filesystem::resize_file(file.path, sizeof(SnapshotHeader) + 8);
+    EXPECT_THROW(orderBook.LoadSnapshot(file.path), std::runtime_error);
+
+    // Only into an empty book
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 5});
+    EXPECT_THROW(orderBook.LoadSnapshot(file.path), std::logic_error);
+}
+
+TEST(SnapshotTest, EngineRestartsFromSnapshotPlusJournalTail) {
+    TempFile journal("tail.journal");
+    TempFile snapshot("tail.snapshot");
+    MatchingEngineConfig config{.journal_ = JournalConfig{.path_ = journal.path}, .snapshotPath_ = snapshot.path};
+    {
+        MatchingEngine engine(config);
+        engine.Submit(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 101, 5}));
+        engine.Submit(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 101, 5}));
+        engine.Stop();
+        engine.SaveSnapshot(snapshot.path);
+    }
+    {
+        // Records 3 and 4 only exist in the journal
+        MatchingEngine engine(config);
+        engine.Submit(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 3, Side::Buy, 101, 7}));
+        engine.Submit(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 4, Side::Buy, 100, 1}));
+        engine.Stop();
+    }
+
+    MatchingEngine restarted(config);
+    restarted.Stop();
+    const OrderBook &orderBook = restarted.GetOrderBook();
+    EXPECT_EQ(orderBook.Size(), 2);
+    LevelInfo level[1];
+    ASSERT_EQ(orderBook.GetTopLevels(Side::Sell, 1, level), 1);
+    EXPECT_EQ(level[0].quantity_, 3);
+    ASSERT_EQ(orderBook.GetTopLevels(Side::Buy, 1, level), 1);
+    EXPECT_EQ(level[0].price_, 100);
+}
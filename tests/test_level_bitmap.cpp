@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include "../LevelBitmap.h"
+
+TEST(LevelBitmapTest, EmptyBitmap) {
+    LevelBitmap bitmap(1000);
+    EXPECT_TRUE(bitmap.Empty());
+    EXPECT_EQ(bitmap.First(), LevelBitmap::npos);
+    EXPECT_EQ(bitmap.Last(), LevelBitmap::npos);
+}
+
+TEST(LevelBitmapTest, FindsAcrossWordsAndLayers) {
+    // 3 layers: 300000 bits -> 4688 words -> 74 words -> 1 word
+    LevelBitmap bitmap(300000);
+    bitmap.Set(5);
+    bitmap.Set(200000);
+    bitmap.Set(299999);
+
+    EXPECT_EQ(bitmap.First(), 5);
+    EXPECT_EQ(bitmap.FindNext(6), 200000);
+    EXPECT_EQ(bitmap.FindNext(200001), 299999);
+    EXPECT_EQ(bitmap.Last(), 299999);
+    EXPECT_EQ(bitmap.FindPrev(299998), 200000);
+    EXPECT_EQ(bitmap.FindPrev(199999), 5);
+    EXPECT_EQ(bitmap.FindPrev(4), LevelBitmap::npos);
+
+    bitmap.Clear(200000);
+    EXPECT_EQ(bitmap.FindNext(6), 299999);
+    EXPECT_FALSE(bitmap.Test(200000));
+}
+
+TEST(LevelBitmapTest, MatchesOrderedSet) {
+    constexpr size_t size = 5000;
+    LevelBitmap bitmap(size);
+    std::set<size_t> reference;
+    std::mt19937 random(42);
+
+    for (int i = 0; i < 20000; ++i) {
+        const size_t index = random() % size;
+        if (random() % 2) {
+            bitmap.Set(index);
+            reference.insert(index);
+        } else {
+            bitmap.Clear(index);
+            reference.erase(index);
+        }
+
+        const size_t probe = random() % size;
+        auto next = reference.lower_bound(probe);
+        EXPECT_EQ(bitmap.FindNext(probe), next == reference.end() ? LevelBitmap::npos : *next);
+
+        auto prev = reference.upper_bound(probe);
+        EXPECT_EQ(bitmap.FindPrev(probe), prev == reference.begin() ? LevelBitmap::npos : *std::prev(prev));
+    }
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <deque>
+#include <random>
+#include <vector>
+#include "../LevelQueue.h"
+#include "../OrderPool.h"
+
+namespace {
+    std::vector<OrderId> Ids(const LevelQueue &queue) {
+        std::vector<OrderId> ids;
+        for (const Order *order : queue)
+            ids.push_back(order->GetOrderId());
+        return ids;
+    }
+}
+
+TEST(LevelQueueTest, FifoWithHolesFromCancels) {
+    OrderPool pool;
+    LevelQueue queue;
+    std::vector<Order *> orders;
+    for (OrderId orderId = 0; orderId < 5; ++orderId) {
+        orders.push_back(pool.Acquire(OrderType::GoodTillCancel, orderId, Side::Buy, 100, 10 + orderId));
+        queue.push_back(orders.back());
+    }
+
+    queue.erase(orders[2]);
+    queue.erase(orders[4]);
+    EXPECT_EQ(queue.size(), 3u);
+    EXPECT_EQ(Ids(queue), (std::vector<OrderId>{0, 1, 3}));
+
+    // The front skips straight past the hole left by order 2
+    queue.pop_front();
+    queue.pop_front();
+    EXPECT_EQ(queue.front(), orders[3]);
+    EXPECT_EQ(queue.FrontQuantity(), 13);
+
+    queue.Reduce(orders[3], 4);
+    EXPECT_EQ(queue.FrontQuantity(), 9);
+    queue.pop_front();
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.begin(), queue.end());
+}
+
+// Random adds, cancels and fills against a deque model: compaction must keep queue order
+// and every order's slot right, however the holes fall
+TEST(LevelQueueTest, MatchesModelThroughCompactions) {
+    OrderPool pool;
+    LevelQueue queue;
+    std::deque<Order *> model;
+    std::mt19937 random(7);
+    OrderId nextId = 0;
+
+    for (int step = 0; step < 20000; ++step) {
+        const auto action = random() % 10;
+        if (model.empty() || action < 5) {
+            Order *order = pool.Acquire(OrderType::GoodTillCancel, nextId++, Side::Sell, 100, 1 + static_cast<Quantity>(random() % 50));
+            queue.push_back(order);
+            model.push_back(order);
+        } else if (action < 8) {
+            const size_t position = random() % model.size();
+            Order *order = model[position];
+            queue.erase(order);
+            model.erase(model.begin() + static_cast<std::ptrdiff_t>(position));
+            pool.Release(order);
+        } else {
+            Order *order = model.front();
+            ASSERT_EQ(queue.front(), order);
+            ASSERT_EQ(queue.FrontQuantity(), order->GetRemainingQuantity());
+            queue.pop_front();
+            model.pop_front();
+            pool.Release(order);
+        }
+
+        ASSERT_EQ(queue.size(), model.size());
+        if (step % 97 == 0) {
+            std::vector<OrderId> expected;
+            for (const Order *order : model)
+                expected.push_back(order->GetOrderId());
+            ASSERT_EQ(Ids(queue), expected);
+        }
+    }
+}
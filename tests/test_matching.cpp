@@ -32,4 +32,34 @@ TEST(MatchingTest, PartialMatching) {
     EXPECT_EQ(orderBook.Size(), 1); // Buy order still has 5 units remaining
     EXPECT_EQ(buyOrder->GetRemainingQuantity(), 5);
     EXPECT_TRUE(sellOrder->IsFilled());
-}
\ No newline at end of file
+}
+
+// Both sides run the same template, so a flow and its mirror image (sides swapped, prices reflected
+// around 100) must trade the same quantities at the reflected prices
+TEST(MatchingTest, SidesMirrorEachOther) {
+    auto run = [](bool mirrored) {
+        const auto side = [&](Side s) { return mirrored ? (s == Side::Buy ? Side::Sell : Side::Buy) : s; };
+        const auto price = [&](Price p) { return mirrored ? 200 - p : p; };
+        OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+        orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, side(Side::Sell), price(101), 5});
+        orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 2, side(Side::Sell), price(102), 5});
+        orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 3, side(Side::Sell), price(104), 5});
+        Trades trades = orderBook.AddOrder(OrderRequest{OrderType::FillOrKill, 4, side(Side::Buy), price(102), 11});
+        EXPECT_TRUE(trades.empty());
+        trades = orderBook.AddOrder(OrderRequest{OrderType::FillAndKill, 5, side(Side::Buy), price(103), 12});
+        for (const Trade &trade : orderBook.AddOrder(OrderRequest{OrderType::Market, 6, side(Side::Buy), 0, 3}))
+            trades.push_back(trade);
+
+        std::vector<std::pair<Price, Quantity>> fills;
+        for (const Trade &trade : trades) {
+            const TradeInfo &resting = mirrored ? trade.GetBidTrade() : trade.GetAskTrade();
+            fills.emplace_back(price(resting.price_), resting.quantity_);
+        }
+        EXPECT_EQ(orderBook.Size(), 1u);
+        return fills;
+    };
+
+    const auto fills = run(false);
+    EXPECT_EQ(fills, (std::vector<std::pair<Price, Quantity>>{{101, 5}, {102, 5}, {104, 3}}));
+    EXPECT_EQ(run(true), fills);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../OrderBook.h"
+#include "../OrderIndex.h"
+
+namespace {
+    // Orders are only compared by address, the index never looks inside them
+    std::vector<Order> MakeOrders(int count) {
+        std::vector<Order> orders;
+        orders.reserve(count);
+        for (OrderId orderId = 0; orderId < count; ++orderId)
+            orders.emplace_back(OrderType::GoodTillCancel, orderId, Side::Buy, 100, 1);
+        return orders;
+    }
+}
+
+TEST(OrderIndexTest, DenseAndHashedIds) {
+    auto orders = MakeOrders(4);
+    OrderIndex index;
+    index.ConfigureDense(100);
+
+    EXPECT_TRUE(index.Insert(7, OrderEntry{&orders[0]}));
+    EXPECT_TRUE(index.Insert(100, OrderEntry{&orders[1]}));   // First hashed id
+    EXPECT_TRUE(index.Insert(-3, OrderEntry{&orders[2]}));    // Negative ids are hashed too
+    EXPECT_FALSE(index.Insert(7, OrderEntry{&orders[3]}));
+    EXPECT_FALSE(index.Insert(100, OrderEntry{&orders[3]}));
+    EXPECT_EQ(index.size(), 3);
+
+    EXPECT_EQ(index.Find(7)->order_, &orders[0]);
+    EXPECT_EQ(index.Find(100)->order_, &orders[1]);
+    EXPECT_EQ(index.Find(-3)->order_, &orders[2]);
+    EXPECT_EQ(index.Find(8), nullptr);
+    EXPECT_EQ(index.Find(101), nullptr);
+
+    OrderEntry entry;
+    EXPECT_TRUE(index.Extract(7, entry));
+    EXPECT_EQ(entry.order_, &orders[0]);
+    EXPECT_FALSE(index.Extract(7, entry));
+    EXPECT_TRUE(index.Extract(100, entry));
+    EXPECT_EQ(entry.order_, &orders[1]);
+    EXPECT_EQ(index.size(), 1);
+
+    // Dense range can only change while empty
+    EXPECT_THROW(index.ConfigureDense(10), std::logic_error);
+    index.clear();
+    EXPECT_TRUE(index.empty());
+    EXPECT_NO_THROW(index.ConfigureDense(10));
+}
+
+TEST(OrderIndexTest, ReserveOnlyCountsHashedIds) {
+    auto orders = MakeOrders(4);
+    OrderIndex index;
+    index.ConfigureDense(1000);
+    index.Insert(1, OrderEntry{&orders[0]});
+
+    // A burst of dense ids never sizes the hash table
+    std::vector<OrderRequest> dense;
+    for (OrderId orderId = 2; orderId < 900; ++orderId)
+        dense.push_back(OrderRequest{OrderType::GoodTillCancel, orderId, Side::Buy, 100, 1});
+    index.ReserveFor(dense);
+    EXPECT_EQ(index.HashedCapacity(), 0u);
+
+    // Only the hashed ones of a mixed burst get room
+    std::vector<OrderRequest> mixed = {
+        OrderRequest{OrderType::GoodTillCancel, 5, Side::Buy, 100, 1},
+        OrderRequest{OrderType::GoodTillCancel, 5000, Side::Buy, 100, 1},
+        OrderRequest{OrderType::GoodTillCancel, -1, Side::Buy, 100, 1},
+    };
+    index.ReserveFor(mixed);
+    EXPECT_GE(index.HashedCapacity(), 2u);
+    EXPECT_LT(index.HashedCapacity(), 100u);
+    EXPECT_EQ(index.HashedSize(), 0u);
+}
+
+TEST(OrderIndexTest, KeepsOwnersAlive) {
+    auto owned = std::make_shared<Order>(OrderType::GoodTillCancel, 1, Side::Buy, 100, 1);
+    OrderIndex index;
+    index.Insert(1, OrderEntry{owned.get(), owned});
+    EXPECT_EQ(owned.use_count(), 2);
+
+    OrderEntry entry;
+    index.Extract(1, entry);
+    EXPECT_EQ(entry.owner_, owned);
+    entry = OrderEntry{};
+    EXPECT_EQ(owned.use_count(), 1);
+}
+
+// Random churn against std::map: backward shift deletion must never lose an entry that sits behind it in a run
+TEST(OrderIndexTest, ChurnMatchesMap) {
+    auto orders = MakeOrders(1);
+    for (size_t denseIds : {0, 512}) {
+        OrderIndex index;
+        index.ConfigureDense(denseIds);
+        std::map<OrderId, bool> expected;
+        std::mt19937 random(9);
+
+        for (int step = 0; step < 200000; ++step) {
+            // Small key range so runs collide and wrap around the table
+            const auto orderId = static_cast<OrderId>(random() % 4096);
+            OrderEntry entry;
+            if (random() % 3) {
+                EXPECT_EQ(index.Insert(orderId, OrderEntry{&orders[0]}), expected.emplace(orderId, true).second);
+            } else {
+                EXPECT_EQ(index.Extract(orderId, entry), expected.erase(orderId) == 1);
+            }
+        }
+
+        EXPECT_EQ(index.size(), expected.size());
+        for (OrderId orderId = 0; orderId < 4096; ++orderId)
+            EXPECT_EQ(index.contains(orderId), expected.count(orderId) == 1);
+        size_t visited = 0;
+        index.ForEach([&](OrderId orderId, OrderEntry &) {
+            EXPECT_EQ(expected.count(orderId), 1);
+            ++visited;
+        });
+        EXPECT_EQ(visited, expected.size());
+    }
+}
+
+TEST(OrderIndexTest, BookWithDenseIds) {
+    OrderBook orderBook(OrderBookConfig{.denseOrderIds_ = 64, .startPruneThread_ = false});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 5});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1000, Side::Buy, 100, 5});
+
+    // Duplicates are caught on both sides of the dense range
+    auto trades = orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5});
+    EXPECT_TRUE(trades.empty());
+    trades = orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 1000, Side::Sell, 100, 5});
+    EXPECT_TRUE(trades.empty());
+    EXPECT_EQ(orderBook.Size(), 2);
+
+    trades = orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 100, 7});
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(orderBook.Size(), 1);
+    orderBook.CancelOrder(1000);
+    EXPECT_EQ(orderBook.Size(), 0);
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include "../OrderPool.h"
+#include "../OrderList.h"
+
+TEST(OrderPoolTest, AcquireConstructsOrder) {
+    OrderPool pool;
+    Order *order = pool.Acquire(OrderType::GoodTillCancel, 1, Side::Buy, 100.0, 10);
+
+    EXPECT_EQ(order->GetOrderId(), 1);
+    EXPECT_EQ(order->GetRemainingQuantity(), 10);
+    EXPECT_EQ(pool.InUse(), 1);
+}
+
+TEST(OrderPoolTest, ReleasedSlotIsReused) {
+    OrderPool pool(4);
+    Order *first = pool.Acquire(OrderType::GoodTillCancel, 1, Side::Buy, 100.0, 10);
+    pool.Release(first);
+
+    Order *second = pool.Acquire(OrderType::GoodTillCancel, 2, Side::Sell, 101.0, 5);
+    EXPECT_EQ(first, second); // Same slot handed back, no new slab
+    EXPECT_EQ(pool.Capacity(), 4);
+    EXPECT_EQ(pool.InUse(), 1);
+}
+
+TEST(OrderPoolTest, GrowsBySlabWithStableAddresses) {
+    OrderPool pool(2);
+    Order *a = pool.Acquire(OrderType::GoodTillCancel, 1, Side::Buy, 100.0, 10);
+    Order *b = pool.Acquire(OrderType::GoodTillCancel, 2, Side::Buy, 100.0, 10);
+    Order *c = pool.Acquire(OrderType::GoodTillCancel, 3, Side::Buy, 100.0, 10);
+
+    EXPECT_EQ(pool.Capacity(), 4);
+    // Earlier orders are untouched by the growth
+    EXPECT_EQ(a->GetOrderId(), 1);
+    EXPECT_EQ(b->GetOrderId(), 2);
+    EXPECT_EQ(c->GetOrderId(), 3);
+}
+
+TEST(OrderListTest, FifoWithEraseFromMiddle) {
+    OrderPool pool;
+    OrderList orders;
+    Order *a = pool.Acquire(OrderType::GoodTillCancel, 1, Side::Buy, 100.0, 10);
+    Order *b = pool.Acquire(OrderType::GoodTillCancel, 2, Side::Buy, 100.0, 10);
+    Order *c = pool.Acquire(OrderType::GoodTillCancel, 3, Side::Buy, 100.0, 10);
+    orders.push_back(a);
+    orders.push_back(b);
+    orders.push_back(c);
+
+    orders.erase(b);
+    EXPECT_EQ(orders.size(), 2);
+    EXPECT_EQ(orders.front(), a);
+    EXPECT_EQ(orders.back(), c);
+
+    orders.pop_front();
+    EXPECT_EQ(orders.front(), c);
+    orders.pop_front();
+    EXPECT_TRUE(orders.empty());
+}
@@ -63,4 +63,192 @@ TEST(OrderTypeTest, GoodTillCancelOrder) {
     EXPECT_EQ(orderBook.Size(), 0); // Sell order is filled, so order book is empty and rest buy order is removed
 }
 
-// Good for day order testing is left
+TEST(OrderTypeTest, GoodForDayOrdersGoAtTheClose) {
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    // More than one expiry slice
+    const OrderId count = OrderBook::ExpirySliceOrders * 2 + 10;
+    for (OrderId orderId = 0; orderId < count; ++orderId)
+        orderBook.SubmitOrder(OrderRequest{OrderType::GoodForDay, orderId, Side::Buy, 90 + orderId % 5, 1});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, count, Side::Buy, 90, 1});
+    // Filled and cancelled ones leave the index
+    orderBook.SubmitOrder(OrderRequest{OrderType::FillAndKill, count + 1, Side::Sell, 94, 3});
+    orderBook.CancelOrder(5);
+    EXPECT_EQ(orderBook.Size(), count - 3);
+
+    orderBook.CancelGoodForDayOrders();
+    EXPECT_EQ(orderBook.Size(), 1);
+}
+
+TEST(OrderTypeTest, GoodTillTimeExpiresInTimeOrder) {
+    using namespace std::chrono;
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    const ExpiryTime open = sys_days{2026y / 3 / 2} + 9h;
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillTime, 1, Side::Buy, 100, 5, open + 60s});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillTime, 2, Side::Sell, 105, 5, open + 30s});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillTime, 3, Side::Sell, 106, 5, open + 30s});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 4, Side::Buy, 99, 5});
+
+    EXPECT_EQ(orderBook.ExpireOrders(open + 29s), 0);
+    // A modify keeps the expiry, 3 still goes at +30s
+    orderBook.ModifyOrder(OrderModify(3, Side::Sell, 107, 4));
+    EXPECT_EQ(orderBook.ExpireOrders(open + 30s), 2);
+    EXPECT_EQ(orderBook.Size(), 2);
+
+    // Filled before it expires, nothing left to expire for it
+    orderBook.SubmitOrder(OrderRequest{OrderType::FillAndKill, 5, Side::Sell, 100, 5});
+    EXPECT_EQ(orderBook.ExpireOrders(open + 1h), 0);
+    EXPECT_EQ(orderBook.Size(), 1);
+
+    // Slices of maxOrders, earliest first
+    for (OrderId orderId = 10; orderId < 20; ++orderId)
+        orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillTime, orderId, Side::Buy, 98, 1, open + seconds(orderId)});
+    EXPECT_EQ(orderBook.ExpireOrders(open + 1h, 4), 4);
+    EXPECT_EQ(orderBook.ExpireOrders(open + 1h, 4), 4);
+    EXPECT_EQ(orderBook.ExpireOrders(open + 1h, 4), 2);
+    EXPECT_EQ(orderBook.Size(), 1);
+}
+
+TEST(OrderTypeTest, FillOrKillAcrossLevels) {
+    OrderBook orderBook;
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 101, 5});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 3, Side::Sell, 105, 50});
+
+    // 100 and 101 together cover 10, the 105 level is past the limit and must not count
+    auto trades = orderBook.AddOrder(OrderRequest{OrderType::FillOrKill, 4, Side::Buy, 101, 11});
+    EXPECT_TRUE(trades.empty());
+    EXPECT_EQ(orderBook.Size(), 3);
+
+    trades = orderBook.AddOrder(OrderRequest{OrderType::FillOrKill, 5, Side::Buy, 101, 10});
+    EXPECT_EQ(trades.size(), 2);
+    EXPECT_EQ(orderBook.Size(), 1);
+}
+
+TEST(OrderTypeTest, FillOrKillIgnoresOwnSide) {
+    OrderBook orderBook;
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 99, 100});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 100, 5});
+
+    // Resting bids are not liquidity for a buy
+    auto trades = orderBook.AddOrder(OrderRequest{OrderType::FillOrKill, 3, Side::Buy, 100, 10});
+    EXPECT_TRUE(trades.empty());
+    EXPECT_EQ(orderBook.Size(), 2);
+}
+
+// A market order walks as many levels as it needs and never rests, whatever it can't fill is cancelled
+TEST(OrderTypeTest, MarketOrderSweepsLevelsAndNeverRests) {
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 102, 5});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 3, Side::Sell, 103, 5});
+
+    auto trades = orderBook.AddOrder(OrderRequest{OrderType::Market, 4, Side::Buy, 0, 12});
+    ASSERT_EQ(trades.size(), 3);
+    // The market side of each trade carries the price it traded at
+    EXPECT_EQ(trades[0].GetBidTrade().price_, 100);
+    EXPECT_EQ(trades[1].GetBidTrade().price_, 102);
+    EXPECT_EQ(trades[2].GetBidTrade().price_, 103);
+    EXPECT_EQ(trades[2].GetBidTrade().quantity_, 2);
+    EXPECT_EQ(orderBook.Size(), 1);
+
+    // More than the book holds: takes it all, nothing of it is left on the bid side
+    auto marketOrder = std::make_shared<Order>(5, Side::Buy, 10);
+    trades = orderBook.AddOrder(marketOrder);
+    EXPECT_EQ(trades.size(), 1);
+    EXPECT_EQ(marketOrder->GetRemainingQuantity(), 7);
+    EXPECT_EQ(orderBook.Size(), 0);
+    EXPECT_TRUE(orderBook.GetOrderBookLevelInfos().GetBids().empty());
+}
+
+TEST(OrderTypeTest, MarketProtectionStopsTheSweep) {
+    OrderBook orderBook(OrderBookConfig{.marketProtectionTicks_ = 2, .startPruneThread_ = false});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 5});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 98, 5});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 3, Side::Buy, 97, 5});
+
+    // Band is 100 down to 98, the 97 bid is out of reach and the remaining 5 are cancelled
+    auto trades = orderBook.AddOrder(OrderRequest{OrderType::Market, 4, Side::Sell, 0, 15});
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[1].GetAskTrade().price_, 98);
+    auto levels = orderBook.GetOrderBookLevelInfos();
+    ASSERT_EQ(levels.GetBids().size(), 1);
+    EXPECT_EQ(levels.GetBids()[0].price_, 97);
+    EXPECT_TRUE(levels.GetAsks().empty());
+}
+
+TEST(OrderTypeTest, StopTriggersOnlyWhenTradedThrough) {
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 101, 5});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 3, Side::Sell, 102, 5});
+    orderBook.SubmitOrder(OrderRequest{OrderType::Stop, 10, Side::Buy, 0, 3, {}, 101});
+
+    // Waiting stops are counted but not on the book
+    EXPECT_EQ(orderBook.Size(), 4);
+    EXPECT_EQ(orderBook.GetOrderBookLevelInfos().GetBids().size(), 0);
+    EXPECT_EQ(orderBook.GetLastTradePrice(), Constants::InvalidPrice);
+
+    // Prints at 100, under the stop
+    auto trades = orderBook.AddOrder(OrderRequest{OrderType::FillAndKill, 4, Side::Buy, 100, 5});
+    EXPECT_EQ(trades.size(), 1);
+    EXPECT_EQ(orderBook.GetLastTradePrice(), 100);
+    EXPECT_EQ(orderBook.Size(), 3);
+
+    // Prints at 101: the stop goes in as a market order, takes what is left at 101 and walks on to 102
+    trades = orderBook.AddOrder(OrderRequest{OrderType::FillAndKill, 5, Side::Buy, 101, 4});
+    ASSERT_EQ(trades.size(), 3);
+    EXPECT_EQ(trades[1].GetBidTrade().orderId_, 10);
+    EXPECT_EQ(trades[1].GetAskTrade().orderId_, 2);
+    EXPECT_EQ(trades[1].GetAskTrade().quantity_, 1);
+    EXPECT_EQ(trades[2].GetAskTrade().orderId_, 3);
+    EXPECT_EQ(trades[2].GetBidTrade().price_, 102);
+    EXPECT_EQ(trades[2].GetBidTrade().quantity_, 2);
+    EXPECT_EQ(orderBook.Size(), 1);
+}
+
+TEST(OrderTypeTest, SweepReleasesCrossedStopsInTriggerOrder) {
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    for (OrderId orderId = 1; orderId <= 4; ++orderId)
+        orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, orderId, Side::Buy, 101 - orderId, 2});
+    // Sell stops at 99 and 98 (two at 99, first come first), 95 is never reached
+    orderBook.SubmitOrder(OrderRequest{OrderType::StopLimit, 10, Side::Sell, 90, 1, {}, 98});
+    orderBook.SubmitOrder(OrderRequest{OrderType::StopLimit, 11, Side::Sell, 90, 1, {}, 99});
+    orderBook.SubmitOrder(OrderRequest{OrderType::StopLimit, 12, Side::Sell, 90, 1, {}, 99});
+    orderBook.SubmitOrder(OrderRequest{OrderType::StopLimit, 13, Side::Sell, 90, 1, {}, 95});
+
+    // Sweeps 100, 99 and 98: the 99 stops trigger at the second print, 98 at the third
+    auto trades = orderBook.AddOrder(OrderRequest{OrderType::FillAndKill, 20, Side::Sell, 98, 6});
+    ASSERT_EQ(trades.size(), 5);
+    EXPECT_EQ(trades[3].GetAskTrade().orderId_, 11);
+    EXPECT_EQ(trades[3].GetBidTrade().orderId_, 4);
+    EXPECT_EQ(trades[4].GetAskTrade().orderId_, 12);
+    EXPECT_EQ(trades[4].GetBidTrade().orderId_, 4);
+
+    // 10 found no bid left and rests at its limit, 13 is still waiting
+    auto levels = orderBook.GetOrderBookLevelInfos();
+    ASSERT_EQ(levels.GetAsks().size(), 1);
+    EXPECT_EQ(levels.GetAsks()[0].price_, 90);
+    EXPECT_EQ(orderBook.Size(), 2);
+}
+
+TEST(OrderTypeTest, WaitingStopsCancelModifyAndTriggerOnEntry) {
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    orderBook.SubmitOrder(OrderRequest{OrderType::StopLimit, 1, Side::Buy, 106, 5, {}, 105});
+    orderBook.SubmitOrder(OrderRequest{OrderType::StopLimit, 2, Side::Buy, 106, 5, {}, 105});
+    orderBook.CancelOrder(1);
+    // Modify moves the limit, the stop price stays
+    orderBook.ModifyOrder(OrderModify(2, Side::Buy, 107, 4));
+    EXPECT_EQ(orderBook.Size(), 1);
+
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 3, Side::Sell, 105, 1});
+    orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 4, Side::Sell, 107, 10});
+    auto trades = orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 5, Side::Buy, 105, 1});
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[1].GetBidTrade().orderId_, 2);
+    EXPECT_EQ(trades[1].GetBidTrade().quantity_, 4);
+
+    // Last print was 107, a buy stop at 106 goes straight in
+    trades = orderBook.AddOrder(OrderRequest{OrderType::Stop, 6, Side::Buy, 0, 2, {}, 106});
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].GetAskTrade().orderId_, 4);
+}
@@ -28,4 +28,89 @@ TEST_F(OrderBookTest, CancelOrder) {
 
 TEST_F(OrderBookTest, CancelNonExistentOrder) {
     EXPECT_NO_THROW(orderBook->CancelOrder(999));
-}
\ No newline at end of file
+}
+
+TEST_F(OrderBookTest, AddPooledOrder) {
+    auto trades = orderBook->AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 10});
+    EXPECT_TRUE(trades.empty());
+    EXPECT_EQ(orderBook->Size(), 1);
+
+    trades = orderBook->AddOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 100, 4});
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].GetBidTrade().orderId_, 1);
+    EXPECT_EQ(trades[0].GetAskTrade().quantity_, 4);
+    EXPECT_EQ(orderBook->Size(), 1);
+
+    orderBook->CancelOrder(1);
+    EXPECT_EQ(orderBook->Size(), 0);
+}
+
+TEST_F(OrderBookTest, ModifyOrderKeepsType) {
+    orderBook->AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 10});
+    orderBook->ModifyOrder(OrderModify(1, Side::Buy, 101.0, 5));
+    EXPECT_EQ(orderBook->Size(), 1);
+
+    auto levels = orderBook->GetOrderBookLevelInfos();
+    ASSERT_EQ(levels.GetBids().size(), 1);
+    EXPECT_EQ(levels.GetBids()[0].price_, 101.0);
+    EXPECT_EQ(levels.GetBids()[0].quantity_, 5);
+}
+
+TEST_F(OrderBookTest, ModifyDownKeepsQueuePriority) {
+    orderBook->AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 10});
+    orderBook->AddOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 10});
+    orderBook->AddOrder(OrderRequest{OrderType::GoodTillCancel, 3, Side::Sell, 100, 2}); // 1 has 8 left
+
+    // Down to 5 in place, 1 stays in front of 2
+    auto trades = orderBook->ModifyOrder(OrderModify(1, Side::Buy, 100, 5));
+    EXPECT_TRUE(trades.empty());
+    auto levels = orderBook->GetOrderBookLevelInfos();
+    ASSERT_EQ(levels.GetBids().size(), 1);
+    EXPECT_EQ(levels.GetBids()[0].quantity_, 15);
+    EXPECT_EQ(levels.GetBids()[0].count_, 2);
+
+    trades = orderBook->AddOrder(OrderRequest{OrderType::FillAndKill, 4, Side::Sell, 100, 6});
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[0].GetBidTrade().orderId_, 1);
+    EXPECT_EQ(trades[0].GetBidTrade().quantity_, 5);
+    EXPECT_EQ(trades[1].GetBidTrade().orderId_, 2);
+
+    // A size increase goes to the back of the queue
+    orderBook->AddOrder(OrderRequest{OrderType::GoodTillCancel, 5, Side::Buy, 100, 3});
+    orderBook->ModifyOrder(OrderModify(2, Side::Buy, 100, 12));
+    trades = orderBook->AddOrder(OrderRequest{OrderType::FillAndKill, 6, Side::Sell, 100, 1});
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].GetBidTrade().orderId_, 5);
+}
+
+TEST_F(OrderBookTest, LevelTotalsFollowFillsAndCancels) {
+    orderBook->AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 10});
+    orderBook->AddOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 7});
+    orderBook->AddOrder(OrderRequest{OrderType::GoodTillCancel, 3, Side::Sell, 100, 4}); // Partially fills order 1
+
+    auto levels = orderBook->GetOrderBookLevelInfos();
+    ASSERT_EQ(levels.GetBids().size(), 1);
+    EXPECT_EQ(levels.GetBids()[0].quantity_, 13);
+    EXPECT_EQ(levels.GetBids()[0].count_, 2);
+
+    orderBook->CancelOrder(1); // Only its remaining 6 leave the level
+    levels = orderBook->GetOrderBookLevelInfos();
+    ASSERT_EQ(levels.GetBids().size(), 1);
+    EXPECT_EQ(levels.GetBids()[0].quantity_, 7);
+    EXPECT_EQ(levels.GetBids()[0].count_, 1);
+}
+
+TEST_F(OrderBookTest, GetTopLevels) {
+    for (OrderId orderId = 1; orderId <= 5; ++orderId) {
+        orderBook->AddOrder(OrderRequest{OrderType::GoodTillCancel, orderId, Side::Sell, 100 + orderId, orderId});
+    }
+
+    LevelInfo top[3];
+    ASSERT_EQ(orderBook->GetTopLevels(Side::Sell, 3, top), 3);
+    EXPECT_EQ(top[0].price_, 101);
+    EXPECT_EQ(top[0].quantity_, 1);
+    EXPECT_EQ(top[2].price_, 103);
+    EXPECT_EQ(top[2].count_, 1);
+
+    EXPECT_EQ(orderBook->GetTopLevels(Side::Buy, 3, top), 0);
+}
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../Journal.h"
+#include "../LatencyHistogram.h"
+#include "../OrderBook.h"
+#include "../Replay.h"
+
+namespace {
+    struct TempFile {
+        std::string path;
+        explicit TempFile(const std::string &name)
+            : path{(std::filesystem::temp_directory_path() / ("orderbook_" + name)).string()} {
+            std::filesystem::remove(path);
+        }
+        ~TempFile() { std::filesystem::remove(path); }
+    };
+
+    const char *OrderTypeName(OrderType type) {
+        switch (type) {
+        case OrderType::GoodTillCancel: return "GoodTillCancel";
+        case OrderType::FillAndKill: return "FillAndKill";
+        case OrderType::Market: return "Market";
+        case OrderType::GoodForDay: return "GoodForDay";
+        case OrderType::FillOrKill: return "FillOrKill";
+        case OrderType::GoodTillTime: return "GoodTillTime";
+        case OrderType::Stop: return "Stop";
+        case OrderType::StopLimit: return "StopLimit";
+        }
+        return "";
+    }
+
+    std::vector<EngineCommand> RandomCommands(int count) {
+        std::mt19937 random(5);
+        const OrderType types[] = {OrderType::GoodTillCancel, OrderType::GoodForDay, OrderType::FillAndKill,
+                                   OrderType::FillOrKill, OrderType::Market};
+        std::vector<EngineCommand> commands;
+        for (OrderId orderId = 0; orderId < count; ++orderId) {
+            const Side side = random() % 2 ? Side::Buy : Side::Sell;
+            const auto price = static_cast<Price>(95 + random() % 10);
+            switch (random() % 4) {
+            case 0:
+                commands.push_back(EngineCommand::Cancel(static_cast<OrderId>(random() % (orderId + 1))));
+                break;
+            case 1:
+                commands.push_back(EngineCommand::Modify(OrderModify(static_cast<OrderId>(random() % (orderId + 1)), side, price, 1 + random() % 10)));
+                break;
+            default:
+                commands.push_back(EngineCommand::Add(OrderRequest{types[random() % 5], orderId, side, price, static_cast<Quantity>(1 + random() % 20)}));
+            }
+        }
+        return commands;
+    }
+
+    uint64_t DirectChecksum(const std::vector<EngineCommand> &commands) {
+        OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+        for (const auto &command : commands)
+            orderBook.SubmitCommand(command);
+        return orderBook.GetStateChecksum();
+    }
+}
+
+TEST(LatencyHistogramTest, PercentilesWithinBucketPrecision) {
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 100000; ++value)
+        histogram.Record(value);
+
+    EXPECT_EQ(histogram.Count(), 100000u);
+    EXPECT_EQ(histogram.Min(), 1u);
+    EXPECT_EQ(histogram.Max(), 100000u);
+    EXPECT_DOUBLE_EQ(histogram.Mean(), 50000.5);
+    for (double quantile : {0.5, 0.9, 0.99, 0.999}) {
+        const double exact = quantile * 100000;
+        EXPECT_GE(static_cast<double>(histogram.Percentile(quantile)), exact);
+        EXPECT_LE(static_cast<double>(histogram.Percentile(quantile)), exact * 1.035);
+    }
+    EXPECT_EQ(histogram.Percentile(1.0), 100000u);
+
+    // Small values are exact
+    LatencyHistogram small;
+    for (uint64_t value : {3, 7, 7, 40})
+        small.Record(value);
+    EXPECT_EQ(small.Percentile(0.5), 7u);
+    EXPECT_EQ(small.Percentile(1.0), 40u);
+
+    histogram.Merge(small);
+    EXPECT_EQ(histogram.Count(), 100004u);
+    histogram.Reset();
+    EXPECT_EQ(histogram.Count(), 0u);
+    EXPECT_EQ(histogram.Percentile(0.5), 0u);
+}
+
+TEST(LatencyHistogramTest, RecordsTheLargestValues) {
+    // A negative clock delta read as unsigned lands here
+    LatencyHistogram histogram;
+    histogram.Record(std::numeric_limits<uint64_t>::max());
+    histogram.Record(uint64_t{1} << 63);
+    histogram.Record(1);
+
+    EXPECT_EQ(histogram.Count(), 3u);
+    EXPECT_EQ(histogram.Max(), std::numeric_limits<uint64_t>::max());
+    EXPECT_GE(histogram.Percentile(0.6), uint64_t{1} << 63);
+    EXPECT_EQ(histogram.Percentile(1.0), std::numeric_limits<uint64_t>::max());
+}
+
+TEST(ReplayTest, CsvReplayMatchesDirectSubmission) {
+    TempFile file("replay.csv");
+    const auto commands = RandomCommands(3000);
+    {
+        std::ofstream out(file.path);
+        out << "timestamp_ns,command,order_type,order_id,side,price,quantity\n# recorded in a test\n\n";
+        uint64_t timestamp = 1000;
+        for (const auto &command : commands) {
+            const auto &order = command.order_;
+            const char *side = order.side_ == Side::Buy ? "Buy" : "Sell";
+            timestamp += 100;
+            if (command.type_ == CommandType::Cancel)
+                out << timestamp << ",Cancel,," << order.orderId_ << ",,,\n";
+            else if (command.type_ == CommandType::Modify)
+                out << timestamp << ",Modify,," << order.orderId_ << ',' << side << ',' << order.price_ << ',' << order.quantity_ << "\r\n";
+            else
+                out << timestamp << ",Add," << OrderTypeName(order.orderType_) << ',' << order.orderId_ << ','
+                    << side << ',' << order.price_ << ',' << order.quantity_ << '\n';
+        }
+    }
+
+    const ReplayResult result = RunReplay(ReplayConfig{.path_ = file.path});
+    EXPECT_EQ(result.commands_, commands.size());
+    EXPECT_EQ(result.latency_.Count(), commands.size());
+    EXPECT_GT(result.trades_, 0u);
+    EXPECT_EQ(result.bookChecksum_, DirectChecksum(commands));
+}
+
+TEST(ReplayTest, JournalReplayMatchesDirectSubmission) {
+    TempFile file("replay_source.journal");
+    const auto commands = RandomCommands(2000);
+    {
+        Journal journal(JournalConfig{.path_ = file.path, .initialRecords_ = 4096, .sync_ = false});
+        for (const auto &command : commands)
+            journal.Append(command);
+    }
+
+    const ReplayResult result = RunReplay(ReplayConfig{.path_ = file.path});
+    EXPECT_EQ(result.commands_, commands.size());
+    EXPECT_EQ(result.bookChecksum_, DirectChecksum(commands));
+
+    // No timestamps in a journal, so it can't be paced
+    EXPECT_THROW(RunReplay(ReplayConfig{.path_ = file.path, .speed_ = 1}), std::invalid_argument);
+}
+
+TEST(ReplayTest, ChecksumSeesQueueOrder) {
+    OrderBook first(OrderBookConfig{.startPruneThread_ = false});
+    OrderBook second(OrderBookConfig{.startPruneThread_ = false});
+    first.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 5});
+    first.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 5});
+    second.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 5});
+    second.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 5});
+    EXPECT_NE(first.GetStateChecksum(), second.GetStateChecksum());
+
+    second.CancelOrder(2);
+    second.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 5});
+    EXPECT_EQ(first.GetStateChecksum(), second.GetStateChecksum());
+}
+
+TEST(ReplayTest, ChecksumSeesWaitingStopsAndLastTrade) {
+    OrderBook first(OrderBookConfig{.startPruneThread_ = false});
+    OrderBook second(OrderBookConfig{.startPruneThread_ = false});
+    first.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 5});
+    second.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 5});
+    EXPECT_EQ(first.GetStateChecksum(), second.GetStateChecksum());
+
+    // Only the waiting stop tells them apart
+    first.SubmitOrder(OrderRequest{OrderType::Stop, 2, Side::Sell, 0, 3, {}, 95});
+    EXPECT_NE(first.GetStateChecksum(), second.GetStateChecksum());
+    second.SubmitOrder(OrderRequest{OrderType::StopLimit, 2, Side::Sell, 94, 3, {}, 95});
+    EXPECT_NE(first.GetStateChecksum(), second.GetStateChecksum());
+    second.CancelOrder(2);
+    second.SubmitOrder(OrderRequest{OrderType::Stop, 2, Side::Sell, 0, 3, {}, 95});
+    EXPECT_EQ(first.GetStateChecksum(), second.GetStateChecksum());
+
+    // Both empty again, only the price they last traded at differs
+    OrderBook third(OrderBookConfig{.startPruneThread_ = false});
+    OrderBook fourth(OrderBookConfig{.startPruneThread_ = false});
+    third.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 99, 1});
+    third.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 99, 1});
+    fourth.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 98, 1});
+    fourth.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Sell, 98, 1});
+    ASSERT_EQ(third.Size(), 0u);
+    ASSERT_EQ(fourth.Size(), 0u);
+    EXPECT_NE(third.GetStateChecksum(), fourth.GetStateChecksum());
+}
+
+TEST(ReplayTest, PacedReplayFollowsTheRecording) {
+    TempFile file("paced.csv");
+    {
+        std::ofstream out(file.path);
+        // 40ms of recording played at twice the speed
+        out << "0,Add,GoodTillCancel,1,Buy,100,5\n"
+               "20000000,Add,GoodTillCancel,2,Sell,101,5\n"
+               "40000000,Cancel,,1,,,\n";
+    }
+
+    const ReplayResult result = RunReplay(ReplayConfig{.path_ = file.path, .speed_ = 2});
+    EXPECT_EQ(result.commands_, 3u);
+    EXPECT_GE(result.elapsed_, std::chrono::milliseconds(20));
+    EXPECT_EQ(result.restingOrders_, 1u);
+}
+
+TEST(ReplayTest, MalformedLineIsReported) {
+    TempFile file("malformed.csv");
+    {
+        std::ofstream out(file.path);
+        out << "0,Add,GoodTillCancel,1,Buy,100,5\n"
+               "1,Add,GoodTillLunch,2,Buy,100,5\n";
+    }
+
+    try {
+        RunReplay(ReplayConfig{.path_ = file.path});
+        FAIL() << "expected a runtime_error";
+    } catch (const std::runtime_error &error) {
+        EXPECT_EQ(std::string(error.what()), "Malformed replay line 2");
+    }
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include "../MatchingEngine.h"
+#include "../ShardedEngine.h"
+#include "../OrderBook.h"
+
+// The prune thread must notice shutdown right away, even when the book dies immediately after it starts
+TEST(ThreadingTest, ShutdownIsPrompt) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i) {
+        OrderBook orderBook;
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+// CancelOrder takes the orders mutex so concurrent cancels are safe
+TEST(ThreadingTest, ConcurrentCancels) {
+    OrderBook orderBook;
+    for (OrderId orderId = 0; orderId < 1000; ++orderId) {
+        orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, orderId, Side::Buy, 100 + orderId % 10, 10});
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&orderBook, t] {
+            for (OrderId orderId = t; orderId < 1000; orderId += 4)
+                orderBook.CancelOrder(orderId);
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(orderBook.Size(), 0);
+}
+
+TEST(ThreadingTest, MpscRingKeepsPerProducerOrder) {
+    constexpr int producers = 4;
+    constexpr int perProducer = 10000;
+    MpscRing<std::pair<int, int>> ring(1024);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&ring, p] {
+            for (int i = 0; i < perProducer; ++i)
+                while (!ring.TryPush({p, i}))
+                    std::this_thread::yield();
+        });
+    }
+
+    std::vector<int> next(producers, 0);
+    std::pair<int, int> value;
+    for (int received = 0; received < producers * perProducer;) {
+        if (!ring.TryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        EXPECT_EQ(value.second, next[value.first]);
+        next[value.first] = value.second + 1;
+        ++received;
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_FALSE(ring.TryPop(value));
+}
+
+TEST(ThreadingTest, MpscRingReportsFull) {
+    MpscRing<int> ring(2);
+    EXPECT_TRUE(ring.TryPush(1));
+    EXPECT_TRUE(ring.TryPush(2));
+    EXPECT_FALSE(ring.TryPush(3));
+
+    int value;
+    EXPECT_TRUE(ring.TryPop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(ring.TryPush(3));
+}
+
+TEST(ThreadingTest, MatchingEngineReportsInOrder) {
+    MatchingEngine engine;
+    engine.Submit(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5}));
+    engine.Submit(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 8}));
+    engine.Submit(EngineCommand::Modify(OrderModify(2, Side::Buy, 100, 2)));
+    engine.Submit(EngineCommand::Modify(OrderModify(2, Side::Buy, 99, 3)));
+    engine.Submit(EngineCommand::Cancel(2));
+    engine.Stop();
+
+    std::vector<ReportType> types;
+    engine.PollReports([&](const ExecutionReport &report) { types.push_back(report.type_); });
+    EXPECT_EQ(types, (std::vector<ReportType>{ReportType::Accepted, ReportType::Accepted, ReportType::Trade,
+                                              ReportType::Reduced, ReportType::Cancelled, ReportType::Accepted, ReportType::Cancelled}));
+    EXPECT_EQ(engine.GetOrderBook().Size(), 0);
+}
+
+TEST(ThreadingTest, MatchingEngineManyProducers) {
+    constexpr int producers = 4;
+    constexpr int perProducer = 5000;
+    MatchingEngine engine(MatchingEngineConfig{.commandCapacity_ = 1024, .reportCapacity_ = 1024});
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&engine, p] {
+            for (int i = 0; i < perProducer; ++i) {
+                // Buys below sells, nothing crosses
+                const Side side = p % 2 ? Side::Buy : Side::Sell;
+                const Price price = side == Side::Buy ? 90 + i % 5 : 110 + i % 5;
+                engine.Submit(EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, p * perProducer + i, side, price, 1}));
+            }
+        });
+    }
+
+    // Consume while producing so the report ring never blocks the matching thread
+    size_t accepted = 0;
+    while (accepted < producers * perProducer) {
+        engine.PollReports([&](const ExecutionReport &report) {
+            if (report.type_ == ReportType::Accepted)
+                ++accepted;
+        });
+        std::this_thread::yield();
+    }
+    for (auto &thread : threads)
+        thread.join();
+    engine.Stop();
+
+    EXPECT_EQ(engine.GetOrderBook().Size(), producers * perProducer);
+}
+
+TEST(ThreadingTest, ShardedEngineRoutesBySymbol) {
+    ShardedEngine engine(ShardedEngineConfig{.symbols_ = {"AAPL", "MSFT", "TSLA"}, .shards_ = 2});
+    const SymbolId aapl = engine.GetSymbolId("AAPL");
+    const SymbolId tsla = engine.GetSymbolId("TSLA");
+    EXPECT_THROW(engine.GetSymbolId("GOOG"), std::out_of_range);
+
+    // Same order ids on two symbols, and AAPL and TSLA share a worker
+    engine.Submit(aapl, EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 100, 5}));
+    engine.Submit(tsla, EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 1, Side::Sell, 200, 5}));
+    engine.Submit(aapl, EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 5}));
+    engine.Stop();
+
+    std::vector<std::pair<SymbolId, ReportType>> reports;
+    engine.PollReports([&](const ExecutionReport &report) { reports.emplace_back(report.symbolId_, report.type_); });
+    EXPECT_EQ(reports, (std::vector<std::pair<SymbolId, ReportType>>{
+                           {aapl, ReportType::Accepted}, {tsla, ReportType::Accepted}, {aapl, ReportType::Accepted}, {aapl, ReportType::Trade}}));
+    EXPECT_EQ(engine.GetOrderBook(aapl).Size(), 0);
+    EXPECT_EQ(engine.GetOrderBook(tsla).Size(), 1);
+    EXPECT_EQ(engine.GetOrderBook(engine.GetSymbolId("MSFT")).Size(), 0);
+}
+
+TEST(ThreadingTest, ShardedEngineManySymbols) {
+    constexpr int symbols = 64;
+    constexpr int perSymbol = 200;
+    std::vector<std::string> names;
+    for (int s = 0; s < symbols; ++s)
+        names.push_back("SYM" + std::to_string(s));
+    ShardedEngine engine(ShardedEngineConfig{.symbols_ = names, .shards_ = 4, .commandCapacity_ = 256, .reportCapacity_ = 256});
+
+    // One producer per shard's worth of symbols
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 4; ++p) {
+        threads.emplace_back([&engine, p] {
+            for (int i = 0; i < perSymbol; ++i)
+                for (SymbolId symbol = p; symbol < symbols; symbol += 4)
+                    engine.Submit(symbol, EngineCommand::Add(OrderRequest{OrderType::GoodTillCancel, i, Side::Buy, 100 - i % 10, 1}));
+        });
+    }
+
+    size_t accepted = 0;
+    while (accepted < symbols * perSymbol) {
+        engine.PollReports([&](const ExecutionReport &report) {
+            if (report.type_ == ReportType::Accepted)
+                ++accepted;
+        });
+        std::this_thread::yield();
+    }
+    for (auto &thread : threads)
+        thread.join();
+    engine.Stop();
+
+    for (SymbolId symbol = 0; symbol < symbols; ++symbol)
+        EXPECT_EQ(engine.GetOrderBook(symbol).Size(), perSymbol);
+}
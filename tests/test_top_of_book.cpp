@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "../OrderBook.h"
+#include "../SeqLock.h"
+
+TEST(TopOfBookTest, NothingPublishedByDefault) {
+    OrderBook orderBook(OrderBookConfig{.startPruneThread_ = false});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 100, 10});
+
+    const TopOfBook top = orderBook.GetTopOfBook();
+    EXPECT_EQ(top.sequence_, 0u);
+    EXPECT_FALSE(top.HasBid());
+    EXPECT_FALSE(top.HasAsk());
+}
+
+TEST(TopOfBookTest, PublishesAfterEveryCommand) {
+    OrderBook orderBook(OrderBookConfig{.publishedLevels_ = 2, .startPruneThread_ = false});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 1, Side::Buy, 99, 10});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 2, Side::Buy, 100, 5});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 3, Side::Buy, 98, 7});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 4, Side::Sell, 102, 4});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillCancel, 5, Side::Sell, 102, 6});
+
+    TopOfBook top = orderBook.GetTopOfBook();
+    EXPECT_EQ(top.sequence_, 5u);
+    EXPECT_EQ(top.orderCount_, 5u);
+    EXPECT_EQ(top.lastTradePrice_, Constants::InvalidPrice);
+    // Only the configured depth is copied
+    ASSERT_EQ(top.bidLevelCount_, 2u);
+    EXPECT_EQ(top.GetBid(0).price_, 100);
+    EXPECT_EQ(top.GetBid(1).price_, 99);
+    ASSERT_EQ(top.askLevelCount_, 1u);
+    EXPECT_EQ(top.GetAsk(0).quantity_, 10);
+    EXPECT_EQ(top.GetAsk(0).count_, 2);
+
+    // A modify (cancel + add inside) is one command, so one publish
+    orderBook.ModifyOrder(OrderModify(2, Side::Buy, 102, 5));
+    top = orderBook.GetTopOfBook();
+    EXPECT_EQ(top.sequence_, 6u);
+    EXPECT_EQ(top.lastTradePrice_, 102);
+    EXPECT_EQ(top.GetAsk(0).quantity_, 5);
+    EXPECT_EQ(top.GetBid(0).price_, 99);
+    EXPECT_EQ(top.bidLevelCount_, 2u);
+
+    // Levels that went away are not reported, whatever is left in the rows past the counts
+    orderBook.CancelOrder(1);
+    orderBook.CancelOrder(3);
+    top = orderBook.GetTopOfBook();
+    EXPECT_FALSE(top.HasBid());
+    EXPECT_EQ(top.askLevelCount_, 1u);
+}
+
+TEST(TopOfBookTest, ExpiryWithNothingDuePublishesNothing) {
+    OrderBook orderBook(OrderBookConfig{.publishedLevels_ = 2, .startPruneThread_ = false});
+    const ExpiryTime expiry{std::chrono::seconds{1000}};
+    orderBook.AddOrder(OrderRequest{OrderType::GoodTillTime, 1, Side::Buy, 100, 5, expiry});
+    orderBook.AddOrder(OrderRequest{OrderType::GoodForDay, 2, Side::Buy, 99, 5});
+    ASSERT_EQ(orderBook.GetTopOfBook().sequence_, 2u);
+
+    // Engines poll these while idle, a poll that finds nothing isn't a command
+    EXPECT_EQ(orderBook.ExpireOrders(expiry - std::chrono::seconds{1}), 0u);
+    EXPECT_EQ(orderBook.GetTopOfBook().sequence_, 2u);
+
+    EXPECT_EQ(orderBook.ExpireOrders(expiry), 1u);
+    EXPECT_EQ(orderBook.GetTopOfBook().sequence_, 3u);
+    orderBook.CancelGoodForDayOrders();
+    EXPECT_EQ(orderBook.GetTopOfBook().sequence_, 4u);
+    orderBook.CancelGoodForDayOrders();
+    EXPECT_EQ(orderBook.GetTopOfBook().sequence_, 4u);
+}
+
+// Readers on another thread never see a half written copy: every level is a whole number of
+// 10 lot orders and the sides are sorted and uncrossed, whatever the writer is doing at the time
+TEST(TopOfBookTest, ConcurrentReaderSeesConsistentCopies) {
+    OrderBook orderBook(OrderBookConfig{.publishedLevels_ = TopOfBook::MaxLevels, .startPruneThread_ = false});
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    std::atomic<uint64_t> reads{0};
+
+    std::thread reader([&] {
+        uint64_t lastSequence = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            const TopOfBook top = orderBook.GetTopOfBook();
+            reads.fetch_add(1, std::memory_order_relaxed);
+            bool ok = top.sequence_ >= lastSequence;
+            lastSequence = top.sequence_;
+            auto wholeOrders = [](const LevelInfo &level) { return level.count_ > 0 && level.quantity_ == 10 * level.count_; };
+            for (size_t i = 0; i < top.bidLevelCount_; ++i)
+                ok = ok && wholeOrders(top.GetBid(i)) && (i == 0 || top.GetBid(i).price_ < top.GetBid(i - 1).price_);
+            for (size_t i = 0; i < top.askLevelCount_; ++i)
+                ok = ok && wholeOrders(top.GetAsk(i)) && (i == 0 || top.GetAsk(i).price_ > top.GetAsk(i - 1).price_);
+            if (top.HasBid() && top.HasAsk())
+                ok = ok && top.GetBid(0).price_ < top.GetAsk(0).price_;
+            if (!ok)
+                failures.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // On a single core the writer could otherwise be done before the reader ever runs
+    while (reads.load(std::memory_order_relaxed) == 0)
+        std::this_thread::yield();
+
+    constexpr OrderId orders = 20000;
+    for (OrderId orderId = 0; orderId < orders; ++orderId) {
+        const bool buy = orderId % 2 == 0;
+        const Price price = buy ? 90 + orderId % 10 : 101 + orderId % 10;
+        orderBook.SubmitOrder(OrderRequest{OrderType::GoodTillCancel, orderId, buy ? Side::Buy : Side::Sell, price, 10});
+        if (orderId % 3 == 0)
+            orderBook.CancelOrder(orderId / 2);
+        // Takes exactly one resting order off the best ask
+        if (orderId % 7 == 0)
+            orderBook.SubmitOrder(OrderRequest{OrderType::FillAndKill, orders + orderId, Side::Buy, 110, 10});
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    EXPECT_EQ(failures.load(), 0);
+    const TopOfBook top = orderBook.GetTopOfBook();
+    EXPECT_EQ(top.orderCount_, orderBook.Size());
+}
+
+TEST(TopOfBookTest, SeqLockRoundTrips) {
+    struct Pair {
+        uint64_t first_;
+        uint64_t second_;
+    };
+    SeqLock<Pair> lock;
+    EXPECT_EQ(lock.Load().first_, 0u);
+    lock.Store(Pair{1, 2});
+    lock.Store(Pair{3, 4});
+    Pair pair = lock.Load();
+    EXPECT_EQ(pair.first_, 3u);
+    EXPECT_EQ(pair.second_, 4u);
+
+    // A partial store leaves the words past it alone
+    lock.Store(Pair{5, 6}, sizeof(uint64_t));
+    pair = lock.Load();
+    EXPECT_EQ(pair.first_, 5u);
+    EXPECT_EQ(pair.second_, 4u);
+}